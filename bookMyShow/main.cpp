@@ -1,4 +1,9 @@
 #include <bits/stdc++.h>
+#include <csignal>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
 using namespace std;
 
 enum class SeatCategory
@@ -19,7 +24,8 @@ enum class SeatStatus
 {
     Available,
     Booked,
-    Blocked
+    Blocked,
+    Held     // reserved while payment is in flight
 };
 
 enum class BookingStatus
@@ -30,7 +36,7 @@ enum class BookingStatus
 };
 
 // Forward declarations
-class Show;
+class Screen;
 class Theatre;
 
 class Seat
@@ -72,135 +78,6 @@ public:
     void releaseSeat() { status = SeatStatus::Available; }
 };
 
-class Screen
-{
-private:
-    int screenID;
-    vector<Show*> shows;
-    vector<Seat*> seats;
-    int totalSeats;
-
-public:
-    // Default constructor
-    Screen(){};
-    Screen(int id, int totalSeats) : screenID(id), totalSeats(totalSeats) {
-        initializeSeats();
-    }
-    
-    void initializeSeats() {
-        // Initialize seats with different categories and prices
-        int seatID = 1;
-        int economyRows = 5, silverRows = 3, goldRows = 2;
-        int seatsPerRow = totalSeats / (economyRows + silverRows + goldRows);
-        
-        // Economy seats
-        for (int row = 1; row <= economyRows; row++) {
-            for (int seatNum = 1; seatNum <= seatsPerRow; seatNum++) {
-                Seat* seat = new Seat(seatID++, row, seatNum, SeatCategory::Economy, 150.0);
-                seats.push_back(seat);
-            }
-        }
-        
-        // Silver seats
-        for (int row = economyRows + 1; row <= economyRows + silverRows; row++) {
-            for (int seatNum = 1; seatNum <= seatsPerRow; seatNum++) {
-                Seat* seat = new Seat(seatID++, row, seatNum, SeatCategory::Silver, 250.0);
-                seats.push_back(seat);
-            }
-        }
-        
-        // Gold seats
-        for (int row = economyRows + silverRows + 1; row <= economyRows + silverRows + goldRows; row++) {
-            for (int seatNum = 1; seatNum <= seatsPerRow; seatNum++) {
-                Seat* seat = new Seat(seatID++, row, seatNum, SeatCategory::Gold, 400.0);
-                seats.push_back(seat);
-            }
-        }
-    }
-    
-    // Getters
-    int getScreenID() { return screenID; }
-    vector<Show*> getAllShows() { return shows; }
-    vector<Seat*> getAllSeats() { return seats; }
-    
-    // Show management
-    void addShow(Show* show) {
-        shows.push_back(show);
-        // Add all seats to the show
-        for (Seat* seat : seats) {
-            show->addSeat(seat);
-        }
-    }
-    
-    void removeShow(int showID) {
-        shows.erase(
-            remove_if(shows.begin(), shows.end(),
-                [showID](Show* show) { return show->getShowID() == showID; }),
-            shows.end());
-    }
-    
-    Show* getShowByID(int showID) {
-        for (Show* show : shows) {
-            if (show->getShowID() == showID) {
-                return show;
-            }
-        }
-        return nullptr;
-    }
-};
-
-class Theatre
-{
-private:
-    int theatreID;
-    string theatreName;
-    string address;
-    vector<Show*> shows;
-    vector<Screen*> screens;
-    City city;
-
-public:
-    Theatre(int id, string name, string addr, City city) 
-        : theatreID(id), theatreName(name), address(addr), city(city) {}
-    
-    // Getters
-    int getTheatreID() { return theatreID; }
-    string getTheatreName() { return theatreName; }
-    string getAddress() { return address; }
-    City getCity() { return city; }
-    vector<Show*> getAllShows() { return shows; }
-    vector<Screen*> getAllScreens() { return screens; }
-    
-    // Screen management
-    void addScreen(Screen* screen) {
-        screens.push_back(screen);
-    }
-    
-    // Show management
-    void addShow(Show* show) {
-        shows.push_back(show);
-    }
-    
-    vector<Show*> getShowsByMovie(string movieName) {
-        vector<Show*> movieShows;
-        for (Show* show : shows) {
-            if (show->getMovie().getMovieName() == movieName) {
-                movieShows.push_back(show);
-            }
-        }
-        return movieShows;
-    }
-    
-    Show* getShowByID(int showID) {
-        for (Show* show : shows) {
-            if (show->getShowID() == showID) {
-                return show;
-            }
-        }
-        return nullptr;
-    }
-};
-
 class Movie
 {
 private:
@@ -223,7 +100,7 @@ public:
     }
     
     // Getters
-    string getMovieName() const { return name; }
+    const string& getMovieName() const { return name; }
     int getMovieDuration() const { return duration; }
     string getMovieCast() const { return cast; }
     string getGenre() const { return genre; }
@@ -242,165 +119,2082 @@ public:
     }
 };
 
-class MovieController
+// Compact list of seat ordinals (seatID - 1). The first InlineCapacity
+// entries live inside the object, so a typical booking never touches the heap.
+class SeatIndexList
 {
+public:
+    static const int InlineCapacity = 16;
+
 private:
-    set<Movie> movies;
-    unordered_map<City, set<Movie>> cityToMovie;
+    uint16_t inlineSeats[InlineCapacity];
+    uint16_t* seats;
+    int count;
+    int capacity;
+
+    void grow() {
+        int newCapacity = capacity * 2;
+        uint16_t* bigger = new uint16_t[newCapacity];
+        copy(seats, seats + count, bigger);
+        if (seats != inlineSeats) {
+            delete[] seats;
+        }
+        seats = bigger;
+        capacity = newCapacity;
+    }
 
 public:
-    MovieController() {};
+    SeatIndexList() : seats(inlineSeats), count(0), capacity(InlineCapacity) {}
+
+    SeatIndexList(const SeatIndexList& other) : SeatIndexList() {
+        *this = other;
+    }
+
+    SeatIndexList& operator=(const SeatIndexList& other) {
+        if (this != &other) {
+            clear();
+            for (int ordinal : other) {
+                push_back(ordinal);
+            }
+        }
+        return *this;
+    }
+
+    ~SeatIndexList() {
+        if (seats != inlineSeats) {
+            delete[] seats;
+        }
+    }
+
+    void push_back(int ordinal) {
+        if (count == capacity) {
+            grow();
+        }
+        seats[count++] = (uint16_t)ordinal;
+    }
+
+    void clear() { count = 0; }
+    int size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](int i) const { return seats[i]; }
+    const uint16_t* begin() const { return seats; }
+    const uint16_t* end() const { return seats + count; }
+};
+
+// Knobs for surge pricing. Occupancy above the threshold and a high booking
+// velocity each add to the multiplier; the sum is capped.
+struct SurgePolicy
+{
+    double occupancyThreshold = 0.5;     // surge starts once this share of a category is taken
+    double occupancyWeight = 0.6;        // extra multiplier when the category is full
+    double velocityReference = 2.0;      // seats/second that counts as "hot"
+    double velocityWeight = 0.4;         // extra multiplier at or above the reference velocity
+    double velocityHalfLifeSeconds = 300;
+    double maxMultiplier = 2.0;
+    double priceStep = 5.0;              // quoted prices are rounded to this step
+};
+
+// Prices for every category at one moment. A Booking keeps its quote, so the
+// amount charged does not move while the seats are held.
+struct PriceQuote
+{
+    double categoryPrice[3];
+    uint64_t version;
+    double total;
+};
+
+// Per-show surge pricing. Occupancy counters and an exponentially decayed
+// booking velocity are updated on every seat change, so prices are O(1) to
+// read and never require rescanning the seat map.
+class PricingEngine
+{
+private:
+    static const int CategoryCount = 3;
     
-    void addMovie(Movie movie, City city)
-    {
-        movies.insert(movie);
-        cityToMovie[city].insert(movie);
+    SurgePolicy policy;
+    double basePrice[CategoryCount] = {};
+    double currentPrice[CategoryCount] = {};
+    int totalSeats[CategoryCount] = {};
+    int takenSeats[CategoryCount] = {};
+    double velocity = 0.0;   // seats booked per second, decayed
+    double velocityTime = 0.0; // when velocity was last decayed
+    uint64_t version = 0;
+    
+    void reprice(int category) {
+        double multiplier = 1.0;
+        if (totalSeats[category] > 0) {
+            double occupancy = (double)takenSeats[category] / totalSeats[category];
+            if (occupancy > policy.occupancyThreshold) {
+                multiplier += policy.occupancyWeight * (occupancy - policy.occupancyThreshold)
+                            / (1.0 - policy.occupancyThreshold);
+            }
+        }
+        multiplier += policy.velocityWeight * min(1.0, velocity / policy.velocityReference);
+        multiplier = min(multiplier, policy.maxMultiplier);
+        
+        double price = round(basePrice[category] * multiplier / policy.priceStep) * policy.priceStep;
+        if (price != currentPrice[category]) {
+            currentPrice[category] = price;
+            version++;
+        }
+    }
+
+    void decayTo(double now) {
+        double elapsed = now - velocityTime;
+        if (elapsed > 0) {
+            velocity *= exp2(-elapsed / policy.velocityHalfLifeSeconds);
+            velocityTime = now;
+        }
     }
     
-    void removeMovie(Movie movie, City city)
-    {
-        movies.erase(movie);
-        cityToMovie[city].erase(movie);
+    void repriceAll() {
+        for (int c = 0; c < CategoryCount; c++) {
+            reprice(c);
+        }
     }
     
-    vector<Movie> getAllMovies()
-    {
-        vector<Movie> temp(movies.begin(), movies.end());
-        return temp;
+    void refresh(double now) {
+        if (now > velocityTime) {
+            decayTo(now);
+            repriceAll();
+        }
     }
+
+public:
+    PricingEngine(SurgePolicy policy = SurgePolicy()) : policy(policy) {}
     
-    vector<Movie> getMoviesByCity(City city)
-    {
-        vector<Movie> temp(cityToMovie[city].begin(), cityToMovie[city].end());
-        return temp;
+    // Registers a seat as taken; Show releases it right after if it is free
+    void addSeat(SeatCategory category, double price) {
+        int c = (int)category;
+        basePrice[c] = price;
+        totalSeats[c]++;
+        takenSeats[c]++;
+        reprice(c);
     }
     
-    Movie* findMovie(string movieName) {
-        for (const auto& movie : movies) {
-            if (movie.getMovieName() == movieName) {
-                return const_cast<Movie*>(&movie);
-            }
-        }
-        return nullptr;
+    void onSeatTaken(SeatCategory category, double now) {
+        decayTo(now);
+        velocity += log(2.0) / policy.velocityHalfLifeSeconds;
+        takenSeats[(int)category]++;
+        repriceAll();
+    }
+    
+    void onSeatReleased(SeatCategory category, double now) {
+        decayTo(now);
+        takenSeats[(int)category]--;
+        repriceAll();
+    }
+    
+    // Reads decay the velocity to `now` first, so a surge fades once sales stop
+    double getPrice(SeatCategory category, double now) {
+        refresh(now);
+        return currentPrice[(int)category];
+    }
+    double getVelocity() const { return velocity; }
+    uint64_t getVersion() const { return version; }
+    
+    // Called when the show switches clocks, so decay restarts on the new time base
+    void resetClock(double now) { velocityTime = now; }
+    
+    PriceQuote quote(double now) {
+        refresh(now);
+        PriceQuote q;
+        copy(currentPrice, currentPrice + CategoryCount, q.categoryPrice);
+        q.version = version;
+        q.total = 0.0;
+        return q;
     }
 };
 
-class TheatreController
+// FIFO waitlist for a sold-out show. Entries are queued per (category, seat
+// count); a small min-segment-tree over the counts holds each queue's oldest
+// entry, so "earliest waiter needing at most F seats" is O(log MaxGroupSize).
+class Waitlist
 {
+public:
+    static const int MaxGroupSize = 10;
+    typedef function<void(const SeatIndexList&, long long holdID)> OfferCallback;
+    
+    struct Entry {
+        long long entryID;
+        int userID;
+        int seatCount;
+        SeatCategory category;
+        OfferCallback onOffer; // receives seats held for this user and the hold's ID
+    };
+
 private:
-    unordered_map<City, vector<Theatre*>> cityToTheatres;
-    vector<Theatre*> allTheatres;
+    static const int TreeLeaves = 16; // >= MaxGroupSize + 1
+    
+    deque<Entry> queues[3][MaxGroupSize + 1];
+    long long oldest[3][2 * TreeLeaves];
+    unordered_set<long long> waiting;   // entries still queued
+    unordered_set<long long> withdrawn; // queued but no longer wanted
+    long long nextEntryID = 1;
+    
+    void refreshHead(int category, int seatCount) {
+        deque<Entry>& queue = queues[category][seatCount];
+        while (!queue.empty() && withdrawn.erase(queue.front().entryID)) {
+            queue.pop_front();
+        }
+        long long* tree = oldest[category];
+        int node = TreeLeaves + seatCount;
+        tree[node] = queue.empty() ? LLONG_MAX : queue.front().entryID;
+        for (node /= 2; node >= 1; node /= 2) {
+            tree[node] = min(tree[2 * node], tree[2 * node + 1]);
+        }
+    }
+    
+    // Seat count whose queue holds the oldest entry among counts [1, maxSeats], or -1
+    int oldestUpTo(int category, int maxSeats) const {
+        const long long* tree = oldest[category];
+        long long best = LLONG_MAX;
+        int bestNode = -1;
+        for (int lo = TreeLeaves + 1, hi = TreeLeaves + maxSeats + 1; lo < hi; lo /= 2, hi /= 2) {
+            if ((lo & 1) && tree[lo] < best) { best = tree[lo]; bestNode = lo; }
+            if (lo & 1) lo++;
+            if ((hi & 1) && tree[hi - 1] < best) { best = tree[hi - 1]; bestNode = hi - 1; }
+            if (hi & 1) hi--;
+        }
+        if (bestNode == -1) {
+            return -1;
+        }
+        while (bestNode < TreeLeaves) {
+            bestNode = tree[2 * bestNode] == best ? 2 * bestNode : 2 * bestNode + 1;
+        }
+        return bestNode - TreeLeaves;
+    }
 
 public:
-    void addTheatre(Theatre* theatre, City city) {
-        allTheatres.push_back(theatre);
-        cityToTheatres[city].push_back(theatre);
+    Waitlist() {
+        for (auto& tree : oldest) {
+            fill(tree, tree + 2 * TreeLeaves, LLONG_MAX);
+        }
     }
     
-    vector<Theatre*> getTheatresByCity(City city) {
-        return cityToTheatres[city];
+    // Returns the entry ID, or -1 if the seat count is out of range
+    long long join(int userID, int seatCount, SeatCategory category, OfferCallback onOffer) {
+        if (seatCount < 1 || seatCount > MaxGroupSize) {
+            return -1;
+        }
+        long long entryID = nextEntryID++;
+        queues[(int)category][seatCount].push_back({entryID, userID, seatCount, category, move(onOffer)});
+        waiting.insert(entryID);
+        if (queues[(int)category][seatCount].size() == 1) {
+            refreshHead((int)category, seatCount);
+        }
+        return entryID;
     }
     
-    vector<Theatre*> getAllTheatres() {
-        return allTheatres;
+    // Withdrawn entries are skipped lazily when they reach the front
+    void leave(long long entryID) {
+        if (waiting.erase(entryID)) {
+            withdrawn.insert(entryID);
+        }
     }
     
-    Theatre* getTheatreByID(int theatreID) {
-        for (Theatre* theatre : allTheatres) {
-            if (theatre->getTheatreID() == theatreID) {
-                return theatre;
+    // Removes and returns the earliest entry for `category` needing at most `freeSeats`
+    bool popMatch(SeatCategory category, int freeSeats, Entry& out) {
+        int c = (int)category;
+        while (true) {
+            int seatCount = oldestUpTo(c, min(freeSeats, MaxGroupSize));
+            if (seatCount == -1) {
+                return false;
+            }
+            deque<Entry>& queue = queues[c][seatCount];
+            bool isWithdrawn = withdrawn.erase(queue.front().entryID) > 0;
+            if (!isWithdrawn) {
+                out = move(queue.front());
+                waiting.erase(out.entryID);
+            }
+            queue.pop_front();
+            refreshHead(c, seatCount);
+            if (!isWithdrawn) {
+                return true;
             }
         }
-        return nullptr;
     }
+    
+    size_t size() const { return waiting.size(); }
 };
-class Show
+
+enum class JournalOp : uint8_t
 {
-private:
-    string startTime;
-    string endTime;
-    int showID;
-    Movie movie;
-    map<int, Seat*> seatMap; // seatID to Seat mapping
-    Screen* screen;
+    Book,
+    Release,
+    Hold,
+    Expire,
+    Pay
+};
 
-public:
-    Show(){} // Default constructor
-    Show(int ID, string start, string end, Movie movie, Screen* screenPtr)
-    {
-        this->startTime = start;
-        this->endTime = end;
-        this->showID = ID;
-        this->movie = movie;
-        this->screen = screenPtr;
-    }
+// Append-only ledger of seat-state changes (<prefix>.journal) plus compacted
+// snapshots of every show's seat map (<prefix>.snapshot). Appends only queue
+// the record; a flusher thread writes whatever has accumulated and fsyncs
+// once per batch (group commit). Call recover() before the first append.
+// A failed write or fsync is not thrown on the flusher thread: the journal
+// enters a failed state and waitDurable returns false from then on.
+class BookingJournal
+{
+private:
+    struct Record {
+        uint64_t lsn;
+        uint32_t showID;
+        uint32_t value;   // seat ordinal, or booking ID for Pay
+        uint8_t op;
+        uint8_t padding[3];
+        uint32_t checksum;
+    };
+    static_assert(sizeof(Record) == 24, "journal records are fixed size");
     
-    // Getters
-    int getShowID() { return showID; }
-    Movie getMovie() { return movie; }
-    string getStartTime() { return startTime; }
-    string getEndTime() { return endTime; }
-    Screen* getScreen() { return screen; }
+    string journalPath;
+    string snapshotPath;
+    size_t snapshotEveryRecords;
+    int fd;
     
-    // Seat management
-    void addSeat(Seat* seat) {
-        seatMap[seat->getSeatID()] = seat;
-    }
+    mutex lock;                     // pending, seatState, LSN counters
+    condition_variable flushWanted;
+    condition_variable flushed;
+    vector<Record> pending;
+    unordered_map<uint32_t, vector<uint8_t>> seatState; // mirror of what the files describe
+    uint64_t nextLSN = 1;
+    uint64_t durableLSN = 0;
+    size_t recordsSinceSnapshot = 0;
+    long long batches = 0;
+    bool stopping = false;
+    bool failed = false;            // nothing more becomes durable until recover()
+    string failure;
     
-    vector<Seat*> getAvailableSeats() {
-        vector<Seat*> available;
-        for (auto& pair : seatMap) {
-            if (pair.second->isAvailable()) {
-                available.push_back(pair.second);
-            }
+    mutex ioLock;                   // serialises file writes with compaction
+    thread flusher;
+    
+    static uint32_t checksumOf(const Record& r) {
+        const uint8_t* bytes = (const uint8_t*)&r;
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < offsetof(Record, checksum); i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
         }
-        return available;
+        return hash;
     }
     
-    vector<Seat*> getBookedSeats() {
-        vector<Seat*> booked;
-        for (auto& pair : seatMap) {
-            if (pair.second->getStatus() == SeatStatus::Booked) {
-                booked.push_back(pair.second);
-            }
+    static void apply(unordered_map<uint32_t, vector<uint8_t>>& state, const Record& r) {
+        if ((JournalOp)r.op == JournalOp::Pay) {
+            return;
+        }
+        vector<uint8_t>& seats = state[r.showID];
+        if (r.value >= seats.size()) {
+            seats.resize(r.value + 1, (uint8_t)SeatStatus::Available);
+        }
+        switch ((JournalOp)r.op) {
+            case JournalOp::Book: seats[r.value] = (uint8_t)SeatStatus::Booked; break;
+            case JournalOp::Hold: seats[r.value] = (uint8_t)SeatStatus::Held; break;
+            default: seats[r.value] = (uint8_t)SeatStatus::Available; break;
         }
-        return booked;
     }
     
-    bool bookSeats(vector<int> seatIDs) {
-        // Check if all seats are available
-        for (int seatID : seatIDs) {
-            if (seatMap.find(seatID) == seatMap.end() || !seatMap[seatID]->isAvailable()) {
+    // False (with errno set) if a write fails
+    static bool writeAll(int fd, const void* data, size_t size) {
+        const char* bytes = (const char*)data;
+        while (size > 0) {
+            ssize_t written = ::write(fd, bytes, size);
+            if (written < 0) {
+                if (errno == EINTR) continue;
                 return false;
             }
-        }
-        
-        // Book all seats
-        for (int seatID : seatIDs) {
-            seatMap[seatID]->bookSeat();
+            bytes += written;
+            size -= written;
         }
         return true;
     }
     
-    void releaseSeats(vector<int> seatIDs) {
-        for (int seatID : seatIDs) {
-            if (seatMap.find(seatID) != seatMap.end()) {
-                seatMap[seatID]->releaseSeat();
-            }
+    // A rename is durable only once its directory entry is
+    static bool syncDirectoryOf(const string& path) {
+        size_t slash = path.rfind('/');
+        string directory = slash == string::npos ? "." : slash == 0 ? "/" : path.substr(0, slash);
+        int directoryFd = open(directory.c_str(), O_RDONLY);
+        if (directoryFd < 0) {
+            return false;
         }
+        bool ok = fsync(directoryFd) == 0;
+        close(directoryFd);
+        return ok;
     }
     
-    double calculateTotalPrice(vector<int> seatIDs) {
-        double total = 0.0;
-        for (int seatID : seatIDs) {
-            if (seatMap.find(seatID) != seatMap.end()) {
-                total += seatMap[seatID]->getPrice();
-            }
+    // Caller holds `lock`; wakes every waiter so they can see the failure
+    void failLocked(const string& what) {
+        if (!failed) {
+            failed = true;
+            failure = what;
         }
-        return total;
+        flushed.notify_all();
     }
-};
-
+    
+    // Writes and fsyncs records to the journal; "" on success, else the reason
+    string appendToFile(const vector<Record>& records) {
+        if (!writeAll(fd, records.data(), records.size() * sizeof(Record))) {
+            return "journal write failed: " + string(strerror(errno));
+        }
+        if (fsync(fd) != 0) {
+            return "journal fsync failed: " + string(strerror(errno));
+        }
+        return "";
+    }
+    
+    // Temp file, fsync, rename, directory fsync; "" on success, else the reason
+    string writeSnapshot(const unordered_map<uint32_t, vector<uint8_t>>& state, uint64_t snapshotLSN) {
+        string out = "BMSSNAP1";
+        uint32_t showCount = state.size();
+        out.append((const char*)&snapshotLSN, 8).append((const char*)&showCount, 4);
+        for (auto& show : state) {
+            uint32_t seatCount = show.second.size();
+            out.append((const char*)&show.first, 4).append((const char*)&seatCount, 4);
+            string packed((seatCount + 3) / 4, '\0');
+            for (uint32_t s = 0; s < seatCount; s++) {
+                packed[s >> 2] |= (char)(show.second[s] << ((s & 3) * 2));
+            }
+            out += packed;
+        }
+        
+        string tempPath = snapshotPath + ".tmp";
+        int snapshotFd = open(tempPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (snapshotFd < 0) {
+            return "cannot open " + tempPath + ": " + strerror(errno);
+        }
+        string error;
+        if (!writeAll(snapshotFd, out.data(), out.size())) {
+            error = "snapshot write failed: " + string(strerror(errno));
+        } else if (fsync(snapshotFd) != 0) {
+            error = "snapshot fsync failed: " + string(strerror(errno));
+        }
+        if (close(snapshotFd) != 0 && error.empty()) {
+            error = "snapshot close failed: " + string(strerror(errno));
+        }
+        if (error.empty() && rename(tempPath.c_str(), snapshotPath.c_str()) != 0) {
+            error = "snapshot rename failed: " + string(strerror(errno));
+        }
+        if (error.empty() && !syncDirectoryOf(snapshotPath)) {
+            error = "snapshot directory fsync failed: " + string(strerror(errno));
+        }
+        if (!error.empty()) {
+            unlink(tempPath.c_str());
+        }
+        return error;
+    }
+    
+    void flusherLoop() {
+        unique_lock<mutex> guard(lock);
+        while (true) {
+            flushWanted.wait(guard, [this]() { return stopping || !pending.empty(); });
+            if (pending.empty() && stopping) {
+                return;
+            }
+            vector<Record> batch;
+            batch.swap(pending);
+            if (failed) {
+                continue; // the file's tail is unknown; these records cannot be made durable
+            }
+            guard.unlock();
+            string error;
+            {
+                lock_guard<mutex> io(ioLock);
+                error = appendToFile(batch);
+            }
+            guard.lock();
+            if (!error.empty()) {
+                failLocked(error);
+                continue;
+            }
+            durableLSN = max(durableLSN, batch.back().lsn);
+            batches++;
+            flushed.notify_all();
+            if (snapshotEveryRecords > 0 && recordsSinceSnapshot >= snapshotEveryRecords) {
+                guard.unlock();
+                compact();
+                guard.lock();
+            }
+        }
+    }
+
+public:
+    BookingJournal(const string& prefix, size_t snapshotEveryRecords = 0)
+        : journalPath(prefix + ".journal"), snapshotPath(prefix + ".snapshot"),
+          snapshotEveryRecords(snapshotEveryRecords) {
+        fd = open(journalPath.c_str(), O_RDWR | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            throw runtime_error("cannot open " + journalPath);
+        }
+        flusher = thread(&BookingJournal::flusherLoop, this);
+    }
+    
+    ~BookingJournal() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+            flushWanted.notify_one();
+        }
+        flusher.join();
+        close(fd);
+    }
+    
+    // Loads the snapshot, replays the journal tail after it and returns every
+    // show's seat state. A torn record at the end of the journal (crash during
+    // write) is discarded along with anything after it.
+    unordered_map<uint32_t, vector<SeatStatus>> recover() {
+        lock_guard<mutex> io(ioLock);
+        lock_guard<mutex> guard(lock);
+        seatState.clear();
+        uint64_t snapshotLSN = 0;
+        
+        ifstream snapshot(snapshotPath, ios::binary);
+        char magic[8];
+        if (snapshot.read(magic, 8) && memcmp(magic, "BMSSNAP1", 8) == 0) {
+            uint32_t showCount = 0;
+            snapshot.read((char*)&snapshotLSN, 8).read((char*)&showCount, 4);
+            for (uint32_t i = 0; i < showCount && snapshot; i++) {
+                uint32_t showID = 0, seatCount = 0;
+                snapshot.read((char*)&showID, 4).read((char*)&seatCount, 4);
+                vector<uint8_t> packed((seatCount + 3) / 4);
+                snapshot.read((char*)packed.data(), packed.size());
+                vector<uint8_t>& seats = seatState[showID];
+                seats.resize(seatCount);
+                for (uint32_t s = 0; s < seatCount; s++) {
+                    seats[s] = (packed[s >> 2] >> ((s & 3) * 2)) & 3;
+                }
+            }
+        }
+        
+        uint64_t lastLSN = snapshotLSN;
+        off_t validBytes = 0;
+        vector<Record> chunk(1 << 16);
+        lseek(fd, 0, SEEK_SET);
+        bool torn = false;
+        while (!torn) {
+            ssize_t got = ::read(fd, chunk.data(), chunk.size() * sizeof(Record));
+            if (got <= 0) break;
+            size_t records = got / sizeof(Record);
+            for (size_t i = 0; i < records; i++) {
+                const Record& r = chunk[i];
+                if (r.checksum != checksumOf(r) || (r.lsn > snapshotLSN && r.lsn <= lastLSN)) {
+                    torn = true;
+                    break;
+                }
+                validBytes += sizeof(Record);
+                if (r.lsn > snapshotLSN) {
+                    apply(seatState, r);
+                    lastLSN = r.lsn;
+                }
+            }
+            if (got % sizeof(Record) != 0) break;
+        }
+        nextLSN = lastLSN + 1;
+        durableLSN = lastLSN;
+        recordsSinceSnapshot = 0;
+        failed = false;
+        failure.clear();
+        // Appending after a torn tail that is still there would hide every later record
+        if (ftruncate(fd, validBytes) != 0 || fsync(fd) != 0) {
+            failLocked("journal truncate failed: " + string(strerror(errno)));
+        }
+        
+        unordered_map<uint32_t, vector<SeatStatus>> result;
+        for (auto& show : seatState) {
+            vector<SeatStatus>& seats = result[show.first];
+            for (uint8_t status : show.second) {
+                seats.push_back((SeatStatus)status);
+            }
+        }
+        return result;
+    }
+    
+    // Queues a record and returns its LSN; it is durable once waitDurable(lsn) returns
+    uint64_t append(JournalOp op, int showID, int value) {
+        lock_guard<mutex> guard(lock);
+        Record r{};
+        r.lsn = nextLSN++;
+        r.showID = showID;
+        r.value = value;
+        r.op = (uint8_t)op;
+        r.checksum = checksumOf(r);
+        apply(seatState, r);
+        pending.push_back(r);
+        recordsSinceSnapshot++;
+        if (pending.size() == 1) {
+            flushWanted.notify_one();
+        }
+        return r.lsn;
+    }
+    
+    // True once the record is durable; false if the journal failed first
+    bool waitDurable(uint64_t lsn) {
+        unique_lock<mutex> guard(lock);
+        flushed.wait(guard, [this, lsn]() { return durableLSN >= lsn || failed; });
+        return durableLSN >= lsn;
+    }
+    
+    // Why the journal stopped accepting records, or "" while it is healthy
+    string getFailure() {
+        lock_guard<mutex> guard(lock);
+        return failure;
+    }
+    
+    // Writes a packed 2-bit-per-seat snapshot of every show and, only once it
+    // is durably in place, truncates the journal; records appended meanwhile
+    // go to the new journal. If the snapshot fails, the records it would have
+    // covered go to the journal as usual and false is returned.
+    bool compact() {
+        lock_guard<mutex> io(ioLock);
+        vector<Record> batch;
+        unordered_map<uint32_t, vector<uint8_t>> state;
+        uint64_t snapshotLSN;
+        {
+            lock_guard<mutex> guard(lock);
+            if (failed) {
+                return false;
+            }
+            batch.swap(pending);
+            state = seatState;
+            snapshotLSN = nextLSN - 1;
+            recordsSinceSnapshot = 0;
+        }
+        
+        string snapshotError = writeSnapshot(state, snapshotLSN);
+        string error;
+        if (snapshotError.empty()) {
+            // The snapshot covers everything up to snapshotLSN, including `batch`.
+            // If the truncate fails, recover() skips those records anyway.
+            if (ftruncate(fd, 0) != 0 || fsync(fd) != 0) {
+                cerr << "Warning: journal not truncated after snapshot: " << strerror(errno) << endl;
+            }
+        } else {
+            cerr << "Warning: " << snapshotError << "; keeping the journal" << endl;
+            if (!batch.empty()) {
+                error = appendToFile(batch);
+            }
+        }
+        
+        lock_guard<mutex> guard(lock);
+        if (!error.empty()) {
+            failLocked(error);
+            return false;
+        }
+        if (snapshotError.empty()) {
+            durableLSN = max(durableLSN, snapshotLSN);
+        } else if (!batch.empty()) {
+            durableLSN = max(durableLSN, batch.back().lsn);
+        }
+        flushed.notify_all();
+        return snapshotError.empty();
+    }
+    
+    long long getBatchCount() {
+        lock_guard<mutex> guard(lock);
+        return batches;
+    }
+};
+
+// Versioned change feed for one show's seat map. Every seat-changing call on
+// the show becomes one update: the version is bumped and the changes are
+// encoded once into a compact frame (varint version, varint count, then per
+// seat varint(ordinal delta << 2 | status)). Subscribers are split into
+// shards; each shard's thread copies the shared frame pointer into its
+// subscribers' queues, so publishing never waits for viewers.
+class SeatMapFeed
+{
+public:
+    typedef shared_ptr<const string> Frame;
+
+private:
+    struct PublishedFrame {
+        uint64_t version;
+        Frame bytes;
+        chrono::steady_clock::time_point publishedAt;
+    };
+    
+    struct Subscriber {
+        deque<Frame> queue;
+        bool needsResync = false;
+        bool active = true;
+    };
+    
+    struct Shard {
+        mutex lock;
+        vector<Subscriber> subscribers;
+        uint64_t deliveredVersion = 0;
+        thread worker;
+    };
+    
+    size_t queueLimit;
+    size_t historyLimit;
+    mutex lock;                        // version, history, stats
+    condition_variable published;
+    uint64_t version = 0;
+    deque<PublishedFrame> history;     // most recent frames, oldest first
+    vector<unique_ptr<Shard>> shards;
+    bool stopping = false;
+    int nextShard = 0;
+    vector<double> fanOutMicros;       // per update, slowest shard
+    vector<int> shardsPending;         // per update still being fanned out, indexed by version % historyLimit
+    
+    static void putVarint(string& out, uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((char)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((char)value);
+    }
+    
+    static uint64_t getVarint(const string& in, size_t& pos) {
+        uint64_t value = 0;
+        for (int shift = 0; pos < in.size(); shift += 7) {
+            uint8_t byte = in[pos++];
+            value |= (uint64_t)(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        return value;
+    }
+    
+    void shardLoop(Shard* shard) {
+        while (true) {
+            vector<PublishedFrame> frames;
+            bool missed = false;
+            {
+                unique_lock<mutex> guard(lock);
+                published.wait(guard, [&]() { return stopping || version > shard->deliveredVersion; });
+                if (stopping) {
+                    return;
+                }
+                if (history.empty() || history.front().version > shard->deliveredVersion + 1) {
+                    missed = true; // fell behind the history window
+                }
+                for (const PublishedFrame& frame : history) {
+                    if (frame.version > shard->deliveredVersion) frames.push_back(frame);
+                }
+            }
+            {
+                lock_guard<mutex> guard(shard->lock);
+                for (Subscriber& subscriber : shard->subscribers) {
+                    if (!subscriber.active || subscriber.needsResync) continue;
+                    if (missed || subscriber.queue.size() + frames.size() > queueLimit) {
+                        subscriber.queue.clear();
+                        subscriber.needsResync = true;
+                        continue;
+                    }
+                    for (const PublishedFrame& frame : frames) {
+                        subscriber.queue.push_back(frame.bytes);
+                    }
+                }
+                shard->deliveredVersion = frames.empty() ? shard->deliveredVersion : frames.back().version;
+            }
+            auto now = chrono::steady_clock::now();
+            lock_guard<mutex> guard(lock);
+            for (const PublishedFrame& frame : frames) {
+                if (--shardsPending[frame.version % historyLimit] == 0) {
+                    fanOutMicros.push_back(chrono::duration<double, micro>(now - frame.publishedAt).count());
+                }
+            }
+        }
+    }
+
+public:
+    SeatMapFeed(int shardCount = 4, size_t queueLimit = 256, size_t historyLimit = 4096)
+        : queueLimit(queueLimit), historyLimit(historyLimit), shardsPending(historyLimit, 0) {
+        for (int i = 0; i < shardCount; i++) {
+            shards.emplace_back(new Shard());
+        }
+        for (auto& shard : shards) {
+            shard->worker = thread(&SeatMapFeed::shardLoop, this, shard.get());
+        }
+    }
+    
+    ~SeatMapFeed() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+            published.notify_all();
+        }
+        for (auto& shard : shards) {
+            shard->worker.join();
+        }
+    }
+    
+    // Called by Show with its seat lock held, so versions follow seat order
+    uint64_t publish(vector<pair<int, SeatStatus>>& changes) {
+        // Stable, so a seat changed twice in one update keeps its final status last
+        stable_sort(changes.begin(), changes.end(),
+            [](const pair<int, SeatStatus>& a, const pair<int, SeatStatus>& b) { return a.first < b.first; });
+        lock_guard<mutex> guard(lock);
+        uint64_t newVersion = version + 1;
+        string bytes;
+        putVarint(bytes, newVersion);
+        putVarint(bytes, changes.size());
+        int previous = 0;
+        for (auto& change : changes) {
+            putVarint(bytes, ((uint64_t)(change.first - previous) << 2) | (uint64_t)change.second);
+            previous = change.first;
+        }
+        history.push_back({newVersion, make_shared<const string>(move(bytes)), chrono::steady_clock::now()});
+        if (history.size() > historyLimit) {
+            history.pop_front();
+        }
+        shardsPending[newVersion % historyLimit] = shards.size();
+        version = newVersion;
+        published.notify_all();
+        return newVersion;
+    }
+    
+    // Subscribers start from the version of a snapshot they already hold
+    int subscribe() {
+        int shardIndex;
+        {
+            lock_guard<mutex> guard(lock);
+            shardIndex = nextShard++ % shards.size();
+        }
+        Shard& shard = *shards[shardIndex];
+        lock_guard<mutex> guard(shard.lock);
+        int slot = shard.subscribers.size();
+        shard.subscribers.emplace_back();
+        return slot * (int)shards.size() + shardIndex;
+    }
+    
+    void unsubscribe(int subscriberID) {
+        Shard& shard = *shards[subscriberID % shards.size()];
+        lock_guard<mutex> guard(shard.lock);
+        Subscriber& subscriber = shard.subscribers[subscriberID / shards.size()];
+        subscriber.active = false;
+        subscriber.queue.clear();
+    }
+    
+    // Moves queued frames into `out`. Returns false if the subscriber fell
+    // behind and must reload a full snapshot (Show::getSeatMapSnapshot).
+    bool poll(int subscriberID, vector<Frame>& out) {
+        Shard& shard = *shards[subscriberID % shards.size()];
+        lock_guard<mutex> guard(shard.lock);
+        Subscriber& subscriber = shard.subscribers[subscriberID / shards.size()];
+        if (subscriber.needsResync) {
+            subscriber.needsResync = false;
+            return false;
+        }
+        for (Frame& frame : subscriber.queue) {
+            out.push_back(move(frame));
+        }
+        subscriber.queue.clear();
+        return true;
+    }
+    
+    // Frames after `sinceVersion` for clients without a subscription; false
+    // if they are no longer in the history window
+    bool getFramesSince(uint64_t sinceVersion, vector<Frame>& out) {
+        lock_guard<mutex> guard(lock);
+        if (sinceVersion < version && (history.empty() || history.front().version > sinceVersion + 1)) {
+            return false;
+        }
+        for (const PublishedFrame& frame : history) {
+            if (frame.version > sinceVersion) out.push_back(frame.bytes);
+        }
+        return true;
+    }
+    
+    uint64_t getVersion() {
+        lock_guard<mutex> guard(lock);
+        return version;
+    }
+    
+    vector<double> takeFanOutLatencies() {
+        lock_guard<mutex> guard(lock);
+        vector<double> result;
+        result.swap(fanOutMicros);
+        return result;
+    }
+    
+    // Applies one frame to a client-side seat map at `mapVersion`. Frames the
+    // map already reflects (e.g. queued before a snapshot) are skipped.
+    static void applyFrame(const string& frame, vector<SeatStatus>& seatMap, uint64_t& mapVersion) {
+        size_t pos = 0;
+        uint64_t frameVersion = getVarint(frame, pos);
+        if (frameVersion <= mapVersion) {
+            return;
+        }
+        mapVersion = frameVersion;
+        uint64_t count = getVarint(frame, pos);
+        int ordinal = 0;
+        for (uint64_t i = 0; i < count; i++) {
+            uint64_t packed = getVarint(frame, pos);
+            ordinal += (int)(packed >> 2);
+            if (ordinal >= (int)seatMap.size()) seatMap.resize(ordinal + 1, SeatStatus::Available);
+            seatMap[ordinal] = (SeatStatus)(packed & 3);
+        }
+    }
+};
+
+class Show;
+
+// One show's part of a group booking. Either list the seats, or leave `seats`
+// empty and ask for `count` seats of `category` (filled in on success).
+struct GroupLeg
+{
+    Show* show;
+    SeatIndexList seats;
+    int count = 0;
+    SeatCategory category = SeatCategory::Economy;
+    PriceQuote quote{};
+};
+
+class Show
+{
+private:
+    // One physical row of the hall. Free seats are tracked as a bitset and the
+    // longest free run is refreshed whenever a seat in the row changes, so the
+    // best-available search only has to look at rows that can fit a request.
+    // Runs never cross an aisle.
+    struct SeatRow {
+        int rowNumber;
+        int firstOrdinal;
+        int length;
+        SeatCategory category;
+        vector<uint64_t> freeBits; // bit i set => seat (firstOrdinal + i) is free
+        int longestRun;
+        int firstColumn;
+        vector<pair<int, int>> aisles; // (first offset past an aisle, columns skipped up to there)
+    };
+    
+    string startTime;
+    string endTime;
+    string showDate; // YYYY-MM-DD
+    int showID;
+    Movie movie;
+    vector<Seat*> seats;           // indexed by seat ordinal (seatID - 1)
+    vector<SeatStatus> seatStatus; // per-show status; Seat objects are shared by every show on the screen
+    vector<int> rowOfSeat;         // seat ordinal -> index into rows
+    vector<SeatCategory> categoryOfSeat;
+    vector<SeatRow> rows;
+    Screen* screen;
+    PricingEngine pricing;
+    double (*clock)() = steadySeconds;
+    mutable mutex seatLock;
+    
+    // Holds with a deadline; a seat's current hold ID tells whether an expiry
+    // entry still applies to it
+    struct HoldExpiry {
+        double at;
+        long long holdID;
+        SeatIndexList seats;
+        bool operator>(const HoldExpiry& other) const { return at > other.at; }
+    };
+    priority_queue<HoldExpiry, vector<HoldExpiry>, greater<HoldExpiry>> holdExpiries;
+    vector<long long> holdOfSeat;
+    long long nextHoldID = 1;
+    
+    int freeSeats[3] = {};
+    BookingJournal* journal = nullptr;
+    SeatMapFeed* feed = nullptr;
+    vector<pair<int, SeatStatus>> unpublished; // changes since the last feed update
+    unique_ptr<Waitlist> waitlist; // created on the first join; most shows never sell out
+    double waitlistOfferSeconds = 300.0;
+    
+    // Locks the seat map for a mutation. Seat changes made while it is held
+    // are published to the change feed as a single update before unlocking.
+    struct SeatUpdate {
+        Show* show;
+        lock_guard<mutex> guard;
+        SeatUpdate(Show* show) : show(show), guard(show->seatLock) {}
+        ~SeatUpdate() {
+            if (show->feed != nullptr && !show->unpublished.empty()) {
+                show->feed->publish(show->unpublished);
+            }
+            show->unpublished.clear();
+        }
+    };
+    
+    static double steadySeconds() {
+        return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+    }
+    
+    bool isFree(const SeatRow& row, int offset) const {
+        return (row.freeBits[offset >> 6] >> (offset & 63)) & 1;
+    }
+    
+    // First position >= from whose free bit equals wantFree, or row.length
+    int scan(const SeatRow& row, int from, bool wantFree) const {
+        while (from < row.length) {
+            uint64_t word = row.freeBits[from >> 6];
+            if (!wantFree) {
+                word = ~word;
+            }
+            word &= ~0ULL << (from & 63);
+            if (word != 0) {
+                return min(row.length, (from & ~63) + __builtin_ctzll(word));
+            }
+            from = (from & ~63) + 64;
+        }
+        return row.length;
+    }
+    
+    // Next run of free seats at or after `from`, cut short at an aisle
+    bool nextRun(const SeatRow& row, int from, int& runStart, int& runEnd) const {
+        runStart = scan(row, from, true);
+        if (runStart >= row.length) {
+            return false;
+        }
+        runEnd = scan(row, runStart, false);
+        auto aisle = upper_bound(row.aisles.begin(), row.aisles.end(), make_pair(runStart, INT_MAX));
+        if (aisle != row.aisles.end() && aisle->first < runEnd) {
+            runEnd = aisle->first;
+        }
+        return true;
+    }
+    
+    // Physical position of a seat in the row, counting aisles
+    static int columnOf(const SeatRow& row, int offset) {
+        auto aisle = upper_bound(row.aisles.begin(), row.aisles.end(), make_pair(offset, INT_MAX));
+        return row.firstColumn + offset + (aisle == row.aisles.begin() ? 0 : prev(aisle)->second);
+    }
+    
+    void refreshLongestRun(SeatRow& row) {
+        int longest = 0;
+        for (int from = 0, runStart, runEnd; nextRun(row, from, runStart, runEnd); from = runEnd) {
+            longest = max(longest, runEnd - runStart);
+        }
+        row.longestRun = longest;
+    }
+    
+    void setStatusLocked(int ordinal, SeatStatus newStatus, double now, bool expired = false) {
+        if (journal != nullptr && newStatus != seatStatus[ordinal]) {
+            JournalOp op = newStatus == SeatStatus::Booked ? JournalOp::Book
+                         : newStatus == SeatStatus::Held ? JournalOp::Hold
+                         : expired ? JournalOp::Expire : JournalOp::Release;
+            journal->append(op, showID, ordinal);
+        }
+        if (feed != nullptr && newStatus != seatStatus[ordinal]) {
+            unpublished.push_back({ordinal, newStatus});
+        }
+        bool wasFree = seatStatus[ordinal] == SeatStatus::Available;
+        bool isNowFree = newStatus == SeatStatus::Available;
+        if (wasFree && !isNowFree) {
+            pricing.onSeatTaken(categoryOfSeat[ordinal], now);
+            freeSeats[(int)categoryOfSeat[ordinal]]--;
+        } else if (!wasFree && isNowFree) {
+            pricing.onSeatReleased(categoryOfSeat[ordinal], now);
+            freeSeats[(int)categoryOfSeat[ordinal]]++;
+        }
+        if (newStatus != SeatStatus::Held) {
+            holdOfSeat[ordinal] = 0;
+        }
+        seatStatus[ordinal] = newStatus;
+        setFreeBitLocked(ordinal, isNowFree);
+    }
+    
+    void setFreeBitLocked(int ordinal, bool free) {
+        SeatRow& row = rows[rowOfSeat[ordinal]];
+        int offset = ordinal - row.firstOrdinal;
+        if (free) {
+            row.freeBits[offset >> 6] |= 1ULL << (offset & 63);
+        } else {
+            row.freeBits[offset >> 6] &= ~(1ULL << (offset & 63));
+        }
+        refreshLongestRun(row);
+    }
+    
+    bool isFreeLocked(int ordinal) const {
+        const SeatRow& row = rows[rowOfSeat[ordinal]];
+        int offset = ordinal - row.firstOrdinal;
+        return (row.freeBits[offset >> 6] >> (offset & 63)) & 1;
+    }
+    
+    // Takes a seat out of (or back into) the free-seat index only, with no
+    // journal, feed or pricing change, so bookGroup can try every leg first
+    void reserveLocked(int ordinal, bool reserve) {
+        setFreeBitLocked(ordinal, !reserve);
+        freeSeats[(int)categoryOfSeat[ordinal]] += reserve ? -1 : 1;
+    }
+    
+    bool findBestAvailableLocked(int count, SeatCategory category, SeatIndexList& out) const {
+        // Vertical centre of the category's block of rows (in doubled units)
+        int firstRow = -1, lastRow = -1;
+        for (int r = 0; r < (int)rows.size(); r++) {
+            if (rows[r].category == category) {
+                if (firstRow == -1) firstRow = r;
+                lastRow = r;
+            }
+        }
+        if (firstRow == -1 || count <= 0) {
+            return false;
+        }
+        
+        long long bestScore = LLONG_MAX;
+        int bestRow = -1, bestStart = -1;
+        for (int r = firstRow; r <= lastRow; r++) {
+            const SeatRow& row = rows[r];
+            if (row.category != category || row.longestRun < count) {
+                continue;
+            }
+            long long rowDistance = abs(2 * r - (firstRow + lastRow));
+            int rowCentre = columnOf(row, 0) + columnOf(row, row.length - 1); // doubled
+            for (int from = 0, runStart, runEnd; nextRun(row, from, runStart, runEnd); from = runEnd) {
+                if (runEnd - runStart >= count) {
+                    // Slide the block as close to the middle of the row as the run
+                    // allows; a run has no aisle inside, so columns are consecutive
+                    int start = runStart + (rowCentre - count + 1) / 2 - columnOf(row, runStart);
+                    start = max(runStart, min(start, runEnd - count));
+                    long long columnDistance = abs(2 * columnOf(row, start) + count - 1 - rowCentre);
+                    long long score = columnDistance + 2 * rowDistance;
+                    if (score < bestScore) {
+                        bestScore = score;
+                        bestRow = r;
+                        bestStart = start;
+                    }
+                }
+            }
+        }
+        if (bestRow == -1) {
+            return false;
+        }
+        
+        out.clear();
+        for (int i = 0; i < count; i++) {
+            out.push_back(rows[bestRow].firstOrdinal + bestStart + i);
+        }
+        return true;
+    }
+
+    // Best contiguous block if there is one, otherwise any free seats of the
+    // category, taken row by row from the middle row outwards
+    bool allocateAnyLocked(int count, SeatCategory category, SeatIndexList& out) const {
+        if (findBestAvailableLocked(count, category, out)) {
+            return true;
+        }
+        if (freeSeats[(int)category] < count) {
+            return false;
+        }
+        vector<int> categoryRows;
+        for (int r = 0; r < (int)rows.size(); r++) {
+            if (rows[r].category == category) categoryRows.push_back(r);
+        }
+        int middle = (categoryRows.front() + categoryRows.back()) / 2;
+        stable_sort(categoryRows.begin(), categoryRows.end(),
+            [middle](int a, int b) { return abs(a - middle) < abs(b - middle); });
+        out.clear();
+        for (int r : categoryRows) {
+            const SeatRow& row = rows[r];
+            for (int offset = scan(row, 0, true); offset < row.length && out.size() < count;
+                 offset = scan(row, offset + 1, true)) {
+                out.push_back(row.firstOrdinal + offset);
+            }
+        }
+        return out.size() == count;
+    }
+    
+    long long holdLocked(const SeatIndexList& seatIndices, double ttlSeconds, double now) {
+        long long holdID = nextHoldID++;
+        for (int ordinal : seatIndices) {
+            setStatusLocked(ordinal, SeatStatus::Held, now);
+            holdOfSeat[ordinal] = holdID;
+        }
+        if (ttlSeconds > 0) {
+            holdExpiries.push({now + ttlSeconds, holdID, seatIndices});
+        }
+        return holdID;
+    }
+    
+    // Offers freed seats to waitlisted users, oldest first. Seats are held for
+    // waitlistOfferSeconds; callbacks run after the lock is released.
+    void serveWaitlist() {
+        struct Offer {
+            Waitlist::Entry entry;
+            SeatIndexList seats;
+            long long holdID;
+        };
+        vector<Offer> offers;
+        {
+            SeatUpdate update(this);
+            if (waitlist == nullptr || waitlist->size() == 0) {
+                return;
+            }
+            double now = clock();
+            for (SeatCategory category : {SeatCategory::Economy, SeatCategory::Silver, SeatCategory::Gold}) {
+                Waitlist::Entry entry;
+                while (freeSeats[(int)category] > 0 && waitlist->popMatch(category, freeSeats[(int)category], entry)) {
+                    SeatIndexList seatsForEntry;
+                    allocateAnyLocked(entry.seatCount, category, seatsForEntry);
+                    long long holdID = holdLocked(seatsForEntry, waitlistOfferSeconds, now);
+                    offers.push_back({move(entry), seatsForEntry, holdID});
+                }
+            }
+        }
+        for (Offer& offer : offers) {
+            offer.entry.onOffer(offer.seats, offer.holdID);
+        }
+    }
+
+public:
+    Show(){} // Default constructor
+    Show(int ID, string start, string end, Movie movie, Screen* screenPtr, string date = "")
+    {
+        this->startTime = start;
+        this->endTime = end;
+        this->showDate = date;
+        this->showID = ID;
+        this->movie = movie;
+        this->screen = screenPtr;
+    }
+    
+    // Getters
+    int getShowID() { return showID; }
+    const Movie& getMovie() { return movie; }
+    string getStartTime() { return startTime; }
+    string getEndTime() { return endTime; }
+    string getShowDate() { return showDate; }
+    Screen* getScreen() { return screen; }
+    
+    // Seat management. Seats must be added in seat-ID order, row by row.
+    // `column` is the seat's physical position (SeatGeometry::column); a jump
+    // of more than one from the previous seat marks an aisle.
+    void reserveSeats(int count) {
+        lock_guard<mutex> guard(seatLock);
+        seats.reserve(count);
+        seatStatus.reserve(count);
+        rowOfSeat.reserve(count);
+        categoryOfSeat.reserve(count);
+        holdOfSeat.reserve(count);
+    }
+    
+    void addSeat(Seat* seat, int column = -1) {
+        lock_guard<mutex> guard(seatLock);
+        int ordinal = seat->getSeatID() - 1;
+        if (ordinal >= (int)seats.size()) {
+            seats.resize(ordinal + 1, nullptr);
+            seatStatus.resize(ordinal + 1, SeatStatus::Blocked);
+            rowOfSeat.resize(ordinal + 1, -1);
+            categoryOfSeat.resize(ordinal + 1, SeatCategory::Economy);
+            holdOfSeat.resize(ordinal + 1, 0);
+        }
+        seats[ordinal] = seat;
+        categoryOfSeat[ordinal] = seat->getSeatCategory();
+        pricing.addSeat(seat->getSeatCategory(), seat->getPrice());
+        
+        if (rows.empty() || rows.back().rowNumber != seat->getSeatRow()) {
+            rows.push_back({seat->getSeatRow(), ordinal, 0, seat->getSeatCategory(), {}, 0, max(column, 0), {}});
+        }
+        SeatRow& row = rows.back();
+        int offset = ordinal - row.firstOrdinal;
+        if (offset > 0 && column > columnOf(row, offset)) {
+            row.aisles.push_back({offset, column - row.firstColumn - offset});
+        }
+        row.length = offset + 1;
+        row.freeBits.resize((row.length + 63) / 64, 0);
+        rowOfSeat[ordinal] = (int)rows.size() - 1;
+        setStatusLocked(ordinal, seat->getStatus(), clock());
+    }
+    
+    // O(1) lookup: returns -1 if the seat ID does not belong to this show
+    int getSeatOrdinal(int seatID) {
+        int ordinal = seatID - 1;
+        if (ordinal < 0 || ordinal >= (int)seats.size() || seats[ordinal] == nullptr) {
+            return -1;
+        }
+        return ordinal;
+    }
+    
+    Seat* getSeatAt(int ordinal) { return seats[ordinal]; }
+    
+    SeatStatus getSeatStatus(int ordinal) {
+        lock_guard<mutex> guard(seatLock);
+        return seatStatus[ordinal];
+    }
+    
+    vector<Seat*> getAvailableSeats() {
+        lock_guard<mutex> guard(seatLock);
+        vector<Seat*> available;
+        for (int ordinal = 0; ordinal < (int)seats.size(); ordinal++) {
+            if (seats[ordinal] != nullptr && seatStatus[ordinal] == SeatStatus::Available) {
+                available.push_back(seats[ordinal]);
+            }
+        }
+        return available;
+    }
+    
+    vector<Seat*> getBookedSeats() {
+        lock_guard<mutex> guard(seatLock);
+        vector<Seat*> booked;
+        for (int ordinal = 0; ordinal < (int)seats.size(); ordinal++) {
+            if (seats[ordinal] != nullptr && seatStatus[ordinal] == SeatStatus::Booked) {
+                booked.push_back(seats[ordinal]);
+            }
+        }
+        return booked;
+    }
+    
+    bool bookSeats(const SeatIndexList& seatIndices) {
+        SeatUpdate update(this);
+        // Check if all seats are available
+        for (int ordinal : seatIndices) {
+            if (seatStatus[ordinal] != SeatStatus::Available) {
+                return false;
+            }
+        }
+        
+        // Book all seats
+        double now = clock();
+        for (int ordinal : seatIndices) {
+            setStatusLocked(ordinal, SeatStatus::Booked, now);
+        }
+        return true;
+    }
+    
+    bool bookSeats(const vector<int>& seatIDs) {
+        SeatIndexList seatIndices;
+        for (int seatID : seatIDs) {
+            int ordinal = getSeatOrdinal(seatID);
+            if (ordinal == -1) {
+                return false;
+            }
+            seatIndices.push_back(ordinal);
+        }
+        return bookSeats(seatIndices);
+    }
+    
+    // Holds reserve seats while payment is in flight: Available -> Held, then
+    // commitHold (Held -> Booked) on success or releaseHold on failure. With a
+    // positive ttlSeconds the hold lapses at the next expireHolds after that.
+    // Returns the hold ID, or 0 if any seat is not available.
+    long long holdSeats(const SeatIndexList& seatIndices, double ttlSeconds = 0) {
+        SeatUpdate update(this);
+        for (int ordinal : seatIndices) {
+            if (seatStatus[ordinal] != SeatStatus::Available) {
+                return 0;
+            }
+        }
+        return holdLocked(seatIndices, ttlSeconds, clock());
+    }
+    
+    // Releases every hold whose deadline has passed; returns seats freed.
+    // Call periodically (e.g. from a sweeper thread).
+    int expireHolds() {
+        int released = 0;
+        {
+            SeatUpdate update(this);
+            double now = clock();
+            while (!holdExpiries.empty() && holdExpiries.top().at <= now) {
+                const HoldExpiry& expiry = holdExpiries.top();
+                for (int ordinal : expiry.seats) {
+                    if (seatStatus[ordinal] == SeatStatus::Held && holdOfSeat[ordinal] == expiry.holdID) {
+                        setStatusLocked(ordinal, SeatStatus::Available, now, true);
+                        released++;
+                    }
+                }
+                holdExpiries.pop();
+            }
+        }
+        if (released > 0) {
+            serveWaitlist();
+        }
+        return released;
+    }
+    
+    // Books the seats only if every one is still held under `holdID`; a hold
+    // that lapsed and was re-offered to someone else fails the commit
+    bool commitHold(const SeatIndexList& seatIndices, long long holdID) {
+        SeatUpdate update(this);
+        for (int ordinal : seatIndices) {
+            if (seatStatus[ordinal] != SeatStatus::Held || holdOfSeat[ordinal] != holdID) {
+                return false;
+            }
+        }
+        double now = clock();
+        for (int ordinal : seatIndices) {
+            setStatusLocked(ordinal, SeatStatus::Booked, now);
+        }
+        return true;
+    }
+    
+    // True while every seat is still held under `holdID`
+    bool isHeldBy(const SeatIndexList& seatIndices, long long holdID) {
+        lock_guard<mutex> guard(seatLock);
+        for (int ordinal : seatIndices) {
+            if (seatStatus[ordinal] != SeatStatus::Held || holdOfSeat[ordinal] != holdID) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    // Frees only the seats still held under `holdID`
+    void releaseHold(const SeatIndexList& seatIndices, long long holdID) {
+        {
+            SeatUpdate update(this);
+            double now = clock();
+            for (int ordinal : seatIndices) {
+                if (seatStatus[ordinal] == SeatStatus::Held && holdOfSeat[ordinal] == holdID) {
+                    setStatusLocked(ordinal, SeatStatus::Available, now);
+                }
+            }
+        }
+        serveWaitlist();
+    }
+    
+    void releaseSeats(const SeatIndexList& seatIndices) {
+        {
+            SeatUpdate update(this);
+            double now = clock();
+            for (int ordinal : seatIndices) {
+                if (seatStatus[ordinal] == SeatStatus::Booked) {
+                    setStatusLocked(ordinal, SeatStatus::Available, now);
+                }
+            }
+        }
+        serveWaitlist();
+    }
+    
+    void releaseSeats(const vector<int>& seatIDs) {
+        SeatIndexList seatIndices;
+        for (int seatID : seatIDs) {
+            int ordinal = getSeatOrdinal(seatID);
+            if (ordinal != -1) {
+                seatIndices.push_back(ordinal);
+            }
+        }
+        releaseSeats(seatIndices);
+    }
+    
+    // All-or-nothing booking across several shows. Show locks are taken in
+    // show-ID order so concurrent groups cannot deadlock; every leg's seats
+    // are picked while all locks are held and only then booked, so no one
+    // ever sees a partial group and a failed group changes nothing.
+    static bool bookGroup(vector<GroupLeg>& legs) {
+        vector<Show*> order;
+        for (GroupLeg& leg : legs) {
+            order.push_back(leg.show);
+        }
+        sort(order.begin(), order.end(), [](Show* a, Show* b) {
+            return a->showID != b->showID ? a->showID < b->showID : a < b;
+        });
+        order.erase(unique(order.begin(), order.end()), order.end());
+        
+        deque<SeatUpdate> updates;
+        for (Show* show : order) {
+            updates.emplace_back(show);
+        }
+        
+        // Pick every leg's seats before booking any. Picked seats leave the
+        // free-seat index so later legs on the same show cannot reuse them;
+        // nothing is journaled, published or priced until all legs fit, so a
+        // group that does not fit leaves no trace.
+        vector<pair<Show*, int>> reserved;
+        bool fits = true;
+        for (GroupLeg& leg : legs) {
+            Show* show = leg.show;
+            if (leg.seats.empty()) {
+                fits = show->allocateAnyLocked(leg.count, leg.category, leg.seats);
+            } else {
+                for (int ordinal : leg.seats) {
+                    fits = fits && show->isFreeLocked(ordinal);
+                }
+            }
+            if (!fits) {
+                break;
+            }
+            for (int ordinal : leg.seats) {
+                show->reserveLocked(ordinal, true);
+                reserved.push_back({show, ordinal});
+            }
+        }
+        for (auto& seat : reserved) {
+            seat.first->reserveLocked(seat.second, false);
+        }
+        if (!fits) {
+            for (GroupLeg& leg : legs) {
+                if (leg.count > 0) {
+                    leg.seats.clear();
+                }
+            }
+            return false;
+        }
+        
+        for (GroupLeg& leg : legs) {
+            Show* show = leg.show;
+            leg.quote = show->quoteLocked(leg.seats);
+            double now = show->clock();
+            for (int ordinal : leg.seats) {
+                show->setStatusLocked(ordinal, SeatStatus::Booked, now);
+            }
+        }
+        return true;
+    }
+    
+    // Best available: `count` adjacent seats of `category`, as close to the
+    // centre of the row and of the category's rows as possible. Read-only; a
+    // concurrent booking may still take the seats before they are booked.
+    bool findBestAvailable(int count, SeatCategory category, SeatIndexList& out) {
+        lock_guard<mutex> guard(seatLock);
+        return findBestAvailableLocked(count, category, out);
+    }
+    
+    // Same search, but books the chosen seats under the same lock. If `quote`
+    // is given it receives the prices in force just before the seats were taken.
+    bool bookBestAvailable(int count, SeatCategory category, SeatIndexList& out, PriceQuote* quote = nullptr) {
+        SeatUpdate update(this);
+        if (!findBestAvailableLocked(count, category, out)) {
+            return false;
+        }
+        if (quote != nullptr) {
+            *quote = quoteLocked(out);
+        }
+        double now = clock();
+        for (int ordinal : out) {
+            setStatusLocked(ordinal, SeatStatus::Booked, now);
+        }
+        return true;
+    }
+    
+    // Waitlist. `onOffer` receives seats already held for the user and the
+    // hold's ID; confirm them with a Booking (markSeatsHeld + confirmBooking)
+    // before the offer lapses. Returns the entry ID, or -1 if seatCount is out of range.
+    long long joinWaitlist(int userID, int seatCount, SeatCategory category, Waitlist::OfferCallback onOffer) {
+        long long entryID;
+        {
+            lock_guard<mutex> guard(seatLock);
+            if (waitlist == nullptr) {
+                waitlist.reset(new Waitlist());
+            }
+            entryID = waitlist->join(userID, seatCount, category, move(onOffer));
+        }
+        serveWaitlist(); // seats may already be free
+        return entryID;
+    }
+    
+    void leaveWaitlist(long long entryID) {
+        lock_guard<mutex> guard(seatLock);
+        if (waitlist != nullptr) {
+            waitlist->leave(entryID);
+        }
+    }
+    
+    size_t getWaitlistSize() {
+        lock_guard<mutex> guard(seatLock);
+        return waitlist != nullptr ? waitlist->size() : 0;
+    }
+    
+    void setWaitlistOfferSeconds(double seconds) { waitlistOfferSeconds = seconds; }
+    
+    // Durability. Every later seat change is appended to the journal.
+    void setJournal(BookingJournal* bookingJournal) {
+        lock_guard<mutex> guard(seatLock);
+        journal = bookingJournal;
+    }
+    
+    BookingJournal* getJournal() { return journal; }
+    
+    // Change feed for live seat maps: viewers load getSeatMapSnapshot once,
+    // then apply frames from the feed whose version is newer than the snapshot
+    void setSeatMapFeed(SeatMapFeed* seatMapFeed) {
+        lock_guard<mutex> guard(seatLock);
+        feed = seatMapFeed;
+    }
+    
+    SeatMapFeed* getSeatMapFeed() { return feed; }
+    
+    vector<SeatStatus> getSeatMapSnapshot(uint64_t& version) {
+        lock_guard<mutex> guard(seatLock);
+        version = feed != nullptr ? feed->getVersion() : 0;
+        return seatStatus;
+    }
+    
+    // Applies seat state from BookingJournal::recover without journaling it again
+    void restoreSeatStates(const vector<SeatStatus>& recovered) {
+        SeatUpdate update(this);
+        BookingJournal* saved = journal;
+        journal = nullptr;
+        double now = clock();
+        for (int ordinal = 0; ordinal < (int)recovered.size() && ordinal < (int)seats.size(); ordinal++) {
+            if (seats[ordinal] != nullptr) {
+                setStatusLocked(ordinal, recovered[ordinal], now);
+            }
+        }
+        journal = saved;
+    }
+    
+    // Pricing
+    void setPricingClock(double (*secondsClock)()) {
+        lock_guard<mutex> guard(seatLock);
+        clock = secondsClock;
+        pricing.resetClock(clock());
+    }
+    
+    double getCurrentPrice(SeatCategory category) {
+        lock_guard<mutex> guard(seatLock);
+        return pricing.getPrice(category, clock());
+    }
+    
+    PriceQuote quote(const SeatIndexList& seatIndices) {
+        lock_guard<mutex> guard(seatLock);
+        return quoteLocked(seatIndices);
+    }
+    
+    double calculateTotalPrice(const SeatIndexList& seatIndices) {
+        return quote(seatIndices).total;
+    }
+    
+    double calculateTotalPrice(const vector<int>& seatIDs) {
+        SeatIndexList seatIndices;
+        for (int seatID : seatIDs) {
+            int ordinal = getSeatOrdinal(seatID);
+            if (ordinal != -1) {
+                seatIndices.push_back(ordinal);
+            }
+        }
+        return calculateTotalPrice(seatIndices);
+    }
+
+private:
+    PriceQuote quoteLocked(const SeatIndexList& seatIndices) {
+        PriceQuote q = pricing.quote(clock());
+        for (int ordinal : seatIndices) {
+            q.total += q.categoryPrice[(int)categoryOfSeat[ordinal]];
+        }
+        return q;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Hall layouts. A layout is declared as blocks of identical rows and compiled
+// into a flat table with one SeatGeometry per seat, in seat-ID order. Tables
+// for common halls are generated at compile time; all shows on a screen
+// share the screen's table.
+// ---------------------------------------------------------------------------
+
+struct RowBlock
+{
+    SeatCategory category;
+    int rows;
+    int seatsPerRow;
+    int aisleEvery; // an aisle after every N seats; 0 for none
+};
+
+struct SeatGeometry
+{
+    uint16_t row;    // 1-based, front to back
+    uint16_t number; // 1-based label within the row
+    uint16_t column; // physical position, counting aisles and the gap that centres short rows
+    SeatCategory category;
+};
+
+constexpr int rowWidth(const RowBlock& block) {
+    return block.seatsPerRow + (block.aisleEvery > 0 ? (block.seatsPerRow - 1) / block.aisleEvery : 0);
+}
+
+constexpr size_t hallSeatCount(const RowBlock* blocks, size_t blockCount) {
+    size_t seats = 0;
+    for (size_t b = 0; b < blockCount; b++) {
+        seats += blocks[b].rows * blocks[b].seatsPerRow;
+    }
+    return seats;
+}
+
+// Writes the geometry of every seat into `table` (std::array or std::vector)
+template <typename Table>
+constexpr void fillHallLayout(const RowBlock* blocks, size_t blockCount, Table& table) {
+    int widest = 0;
+    for (size_t b = 0; b < blockCount; b++) {
+        widest = max(widest, rowWidth(blocks[b]));
+    }
+    size_t index = 0;
+    int row = 1;
+    for (size_t b = 0; b < blockCount; b++) {
+        const RowBlock& block = blocks[b];
+        int gap = (widest - rowWidth(block)) / 2;
+        for (int r = 0; r < block.rows; r++, row++) {
+            for (int s = 0; s < block.seatsPerRow; s++) {
+                int aisles = block.aisleEvery > 0 ? s / block.aisleEvery : 0;
+                table[index++] = SeatGeometry{(uint16_t)row, (uint16_t)(s + 1), (uint16_t)(gap + s + aisles), block.category};
+            }
+        }
+    }
+}
+
+template <size_t SeatCount, size_t BlockCount>
+constexpr array<SeatGeometry, SeatCount> makeHallLayout(const RowBlock (&blocks)[BlockCount]) {
+    array<SeatGeometry, SeatCount> table{};
+    fillHallLayout(blocks, BlockCount, table);
+    return table;
+}
+
+// Non-owning view of a geometry table, cheap to copy. Runtime layouts made
+// by build() keep their table alive through a shared pointer.
+class SeatLayout
+{
+private:
+    const SeatGeometry* table;
+    int seatCount;
+    shared_ptr<const vector<SeatGeometry>> owned;
+
+public:
+    template <size_t SeatCount>
+    SeatLayout(const array<SeatGeometry, SeatCount>& compiled) : table(compiled.data()), seatCount(SeatCount) {}
+    
+    static SeatLayout build(const vector<RowBlock>& blocks) {
+        auto built = make_shared<vector<SeatGeometry>>(hallSeatCount(blocks.data(), blocks.size()));
+        fillHallLayout(blocks.data(), blocks.size(), *built);
+        SeatLayout layout(*built);
+        layout.owned = built;
+        return layout;
+    }
+    
+    int size() const { return seatCount; }
+    const SeatGeometry& operator[](int ordinal) const { return table[ordinal]; }
+    const SeatGeometry* begin() const { return table; }
+    const SeatGeometry* end() const { return table + seatCount; }
+
+private:
+    SeatLayout(const vector<SeatGeometry>& built) : table(built.data()), seatCount((int)built.size()) {}
+};
+
+// 192 seats: Economy and Silver with a centre aisle, a narrower Gold section at the back
+constexpr RowBlock standardHallBlocks[] = {
+    {SeatCategory::Economy, 5, 20, 10},
+    {SeatCategory::Silver, 3, 20, 10},
+    {SeatCategory::Gold, 2, 16, 8},
+};
+constexpr auto standardHall = makeHallLayout<hallSeatCount(standardHallBlocks, 3)>(standardHallBlocks);
+
+// 2000 seats: three aisles in the stalls, two in Gold
+constexpr RowBlock premiereHallBlocks[] = {
+    {SeatCategory::Economy, 20, 50, 13},
+    {SeatCategory::Silver, 12, 50, 13},
+    {SeatCategory::Gold, 10, 40, 14},
+};
+constexpr auto premiereHall = makeHallLayout<hallSeatCount(premiereHallBlocks, 3)>(premiereHallBlocks);
+static_assert(premiereHall.size() == 2000 && premiereHall[1999].row == 42, "premiere hall geometry");
+
+struct CategoryPrices
+{
+    double economy = 150.0;
+    double silver = 250.0;
+    double gold = 400.0;
+    
+    double of(SeatCategory category) const {
+        return category == SeatCategory::Gold ? gold : category == SeatCategory::Silver ? silver : economy;
+    }
+};
+
+class Screen
+{
+private:
+    int screenID;
+    vector<Show*> shows;
+    SeatLayout layout;
+    vector<Seat> seatStorage; // one block for all seats, built from the layout
+    vector<Seat*> seats;
+    int totalSeats;
+    
+    // The original fixed split: 5 Economy, 3 Silver and 2 Gold rows. Seats that
+    // do not divide evenly go one each to the front rows instead of being dropped.
+    static SeatLayout defaultLayout(int totalSeats) {
+        const int rowCount = 10;
+        vector<RowBlock> blocks;
+        for (int r = 0; r < rowCount; r++) {
+            SeatCategory category = r < 5 ? SeatCategory::Economy : r < 8 ? SeatCategory::Silver : SeatCategory::Gold;
+            blocks.push_back({category, 1, totalSeats / rowCount + (r < totalSeats % rowCount ? 1 : 0), 0});
+        }
+        return SeatLayout::build(blocks);
+    }
+
+public:
+    Screen(int id, int totalSeats, CategoryPrices prices = CategoryPrices())
+        : screenID(id), layout(defaultLayout(totalSeats)), totalSeats(totalSeats) {
+        initializeSeats(prices);
+    }
+    
+    Screen(int id, const SeatLayout& hallLayout, CategoryPrices prices = CategoryPrices())
+        : screenID(id), layout(hallLayout), totalSeats(hallLayout.size()) {
+        initializeSeats(prices);
+    }
+    
+    // seats points into seatStorage, so a copy or move would point into the
+    // source screen; deleting the copy operations suppresses the moves too
+    Screen(const Screen&) = delete;
+    Screen& operator=(const Screen&) = delete;
+    
+    // Two allocations per screen regardless of size: the seats and the seat pointers
+    void initializeSeats(CategoryPrices prices) {
+        seatStorage.reserve(layout.size());
+        seats.reserve(layout.size());
+        int seatID = 1;
+        for (const SeatGeometry& geometry : layout) {
+            seatStorage.emplace_back(seatID++, geometry.row, geometry.number, geometry.category, prices.of(geometry.category));
+            seats.push_back(&seatStorage.back());
+        }
+    }
+    
+    // Getters
+    int getScreenID() { return screenID; }
+    int getTotalSeats() { return totalSeats; }
+    const SeatLayout& getLayout() { return layout; }
+    vector<Show*> getAllShows() { return shows; }
+    const vector<Seat*>& getAllSeats() { return seats; }
+    
+    // Seat IDs are assigned sequentially from 1, so lookup is a direct index
+    Seat* getSeatByID(int seatID) {
+        if (seatID < 1 || seatID > (int)seats.size()) {
+            return nullptr;
+        }
+        return seats[seatID - 1];
+    }
+    
+    // Show management
+    void addShow(Show* show) {
+        shows.push_back(show);
+        // Add all seats to the show
+        show->reserveSeats(seats.size());
+        for (int ordinal = 0; ordinal < (int)seats.size(); ordinal++) {
+            show->addSeat(seats[ordinal], layout[ordinal].column);
+        }
+    }
+    
+    void removeShow(int showID) {
+        shows.erase(
+            remove_if(shows.begin(), shows.end(),
+                [showID](Show* show) { return show->getShowID() == showID; }),
+            shows.end());
+    }
+    
+    Show* getShowByID(int showID) {
+        for (Show* show : shows) {
+            if (show->getShowID() == showID) {
+                return show;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class Theatre
+{
+private:
+    int theatreID;
+    string theatreName;
+    string address;
+    vector<Show*> shows;
+    vector<Screen*> screens;
+    City city;
+
+public:
+    Theatre(int id, string name, string addr, City city) 
+        : theatreID(id), theatreName(name), address(addr), city(city) {}
+    
+    // Getters
+    int getTheatreID() { return theatreID; }
+    string getTheatreName() { return theatreName; }
+    string getAddress() { return address; }
+    City getCity() { return city; }
+    vector<Show*> getAllShows() { return shows; }
+    vector<Screen*> getAllScreens() { return screens; }
+    
+    // Screen management
+    void addScreen(Screen* screen) {
+        screens.push_back(screen);
+    }
+    
+    // Show management
+    void addShow(Show* show) {
+        shows.push_back(show);
+    }
+    
+    vector<Show*> getShowsByMovie(const string& movieName) {
+        vector<Show*> movieShows;
+        for (Show* show : shows) {
+            if (show->getMovie().getMovieName() == movieName) {
+                movieShows.push_back(show);
+            }
+        }
+        return movieShows;
+    }
+    
+    Show* getShowByID(int showID) {
+        for (Show* show : shows) {
+            if (show->getShowID() == showID) {
+                return show;
+            }
+        }
+        return nullptr;
+    }
+};
+
+class MovieController
+{
+private:
+    set<Movie> movies;
+    unordered_map<City, set<Movie>> cityToMovie;
+    unordered_map<string, const Movie*> movieByName; // points into `movies`
+
+public:
+    MovieController() {};
+    
+    void addMovie(Movie movie, City city)
+    {
+        auto inserted = movies.insert(movie);
+        movieByName[movie.getMovieName()] = &*inserted.first;
+        cityToMovie[city].insert(movie);
+    }
+    
+    void removeMovie(Movie movie, City city)
+    {
+        movieByName.erase(movie.getMovieName());
+        movies.erase(movie);
+        cityToMovie[city].erase(movie);
+    }
+    
+    vector<Movie> getAllMovies()
+    {
+        vector<Movie> temp(movies.begin(), movies.end());
+        return temp;
+    }
+    
+    vector<Movie> getMoviesByCity(City city)
+    {
+        vector<Movie> temp(cityToMovie[city].begin(), cityToMovie[city].end());
+        return temp;
+    }
+    
+    Movie* findMovie(const string& movieName) {
+        auto it = movieByName.find(movieName);
+        if (it == movieByName.end()) {
+            return nullptr;
+        }
+        return const_cast<Movie*>(it->second);
+    }
+};
+
+// Show index keyed by (city, movie, date), each bucket kept sorted by start
+// time. Movie names are interned to small integer IDs once, so lookups never
+// compare or copy strings and never walk the theatres.
+class ShowCatalog
+{
+public:
+    struct ShowEntry {
+        int startMinute;
+        Show* show;
+        Theatre* theatre;
+    };
+
+private:
+    unordered_map<string, int> movieIDs;
+    vector<string> movieNames;
+    unordered_map<uint64_t, vector<ShowEntry>> showsByKey;
+    
+    static uint64_t makeKey(City city, int movieID, int date) {
+        return ((uint64_t)city << 56) | ((uint64_t)(uint32_t)movieID << 24) | (uint64_t)(date & 0xFFFFFF);
+    }
+    
+    // "YYYY-MM-DD" -> days since 2000-01-01 (only needs to be unique and ordered)
+    static int parseDate(const string& date) {
+        int year = 0, month = 0, day = 0;
+        sscanf(date.c_str(), "%d-%d-%d", &year, &month, &day);
+        return (year - 2000) * 372 + (month - 1) * 31 + (day - 1);
+    }
+    
+    // "HH:MM" -> minutes since midnight
+    static int parseTime(const string& time) {
+        int hours = 0, minutes = 0;
+        sscanf(time.c_str(), "%d:%d", &hours, &minutes);
+        return hours * 60 + minutes;
+    }
+
+public:
+    int internMovie(const string& movieName) {
+        auto it = movieIDs.find(movieName);
+        if (it != movieIDs.end()) {
+            return it->second;
+        }
+        int id = (int)movieNames.size();
+        movieIDs.emplace(movieName, id);
+        movieNames.push_back(movieName);
+        return id;
+    }
+    
+    // -1 if no show of this movie was ever registered
+    int getMovieID(const string& movieName) const {
+        auto it = movieIDs.find(movieName);
+        return it == movieIDs.end() ? -1 : it->second;
+    }
+    
+    const string& getMovieName(int movieID) const { return movieNames[movieID]; }
+    
+    void addShow(Theatre* theatre, Show* show) {
+        int movieID = internMovie(show->getMovie().getMovieName());
+        vector<ShowEntry>& bucket = showsByKey[makeKey(theatre->getCity(), movieID, parseDate(show->getShowDate()))];
+        ShowEntry entry{parseTime(show->getStartTime()), show, theatre};
+        auto pos = upper_bound(bucket.begin(), bucket.end(), entry,
+            [](const ShowEntry& a, const ShowEntry& b) { return a.startMinute < b.startMinute; });
+        bucket.insert(pos, entry);
+    }
+    
+    void removeShow(Theatre* theatre, Show* show) {
+        int movieID = getMovieID(show->getMovie().getMovieName());
+        if (movieID == -1) {
+            return;
+        }
+        auto it = showsByKey.find(makeKey(theatre->getCity(), movieID, parseDate(show->getShowDate())));
+        if (it == showsByKey.end()) {
+            return;
+        }
+        vector<ShowEntry>& bucket = it->second;
+        bucket.erase(remove_if(bucket.begin(), bucket.end(),
+            [show](const ShowEntry& e) { return e.show == show; }), bucket.end());
+    }
+    
+    // All shows of a movie in a city on a date, sorted by start time
+    const vector<ShowEntry>& getShows(City city, int movieID, const string& date) const {
+        static const vector<ShowEntry> none;
+        auto it = showsByKey.find(makeKey(city, movieID, parseDate(date)));
+        return it == showsByKey.end() ? none : it->second;
+    }
+    
+    const vector<ShowEntry>& getShows(City city, const string& movieName, const string& date) const {
+        static const vector<ShowEntry> none;
+        int movieID = getMovieID(movieName);
+        return movieID == -1 ? none : getShows(city, movieID, date);
+    }
+};
+
+class TheatreController
+{
+private:
+    unordered_map<City, vector<Theatre*>> cityToTheatres;
+    unordered_map<int, Theatre*> theatreByID;
+    vector<Theatre*> allTheatres;
+    ShowCatalog catalog;
+
+public:
+    void addTheatre(Theatre* theatre, City city) {
+        allTheatres.push_back(theatre);
+        cityToTheatres[city].push_back(theatre);
+        theatreByID[theatre->getTheatreID()] = theatre;
+    }
+    
+    // Adds the show to the theatre and to the city/movie/date index
+    void addShow(Theatre* theatre, Show* show) {
+        theatre->addShow(show);
+        catalog.addShow(theatre, show);
+    }
+    
+    vector<Theatre*> getTheatresByCity(City city) {
+        return cityToTheatres[city];
+    }
+    
+    vector<Theatre*> getAllTheatres() {
+        return allTheatres;
+    }
+    
+    Theatre* getTheatreByID(int theatreID) {
+        auto it = theatreByID.find(theatreID);
+        return it == theatreByID.end() ? nullptr : it->second;
+    }
+    
+    const vector<ShowCatalog::ShowEntry>& getShowsForMovie(City city, const string& movieName, const string& date) {
+        return catalog.getShows(city, movieName, date);
+    }
+    
+    ShowCatalog& getCatalog() { return catalog; }
+};
+
 class User
 {
 private:
@@ -410,40 +2204,288 @@ private:
     string phoneNumber;
 
 public:
-    User(int id, string name, string email, string phone) 
-        : userID(id), name(name), email(email), phoneNumber(phone) {}
+    User(int id, string name, string email, string phone) 
+        : userID(id), name(name), email(email), phoneNumber(phone) {}
+    
+    // Getters
+    int getUserID() { return userID; }
+    string getName() { return name; }
+    string getEmail() { return email; }
+    string getPhoneNumber() { return phoneNumber; }
+};
+
+class Payment
+{
+private:
+    int paymentID;
+    double amount;
+    string paymentMethod;
+    string paymentDate;
+    string idempotencyKey;
+    bool isCompleted;
+    bool isRefunded;
+
+public:
+    Payment(int id, double amt, string method, string date, string key = "") 
+        : paymentID(id), amount(amt), paymentMethod(method), paymentDate(date), idempotencyKey(key),
+          isCompleted(false), isRefunded(false) {}
+    
+    bool processPayment() {
+        // Simulate payment processing
+        cout << "Processing payment of $" << amount << " via " << paymentMethod << endl;
+        isCompleted = true;
+        return true;
+    }
+    
+    // Gives the money back when the seats could not be booked after the charge
+    void refund() {
+        cout << "Refunding payment of $" << amount << " via " << paymentMethod << endl;
+        isRefunded = true;
+    }
+    
+    // Used by PaymentPipeline once the gateway has charged / refunded the customer
+    void markCompleted() { isCompleted = true; }
+    void markRefunded() { isRefunded = true; }
+    
+    // Getters
+    int getPaymentID() { return paymentID; }
+    double getAmount() { return amount; }
+    string getPaymentMethod() { return paymentMethod; }
+    string getIdempotencyKey() { return idempotencyKey; }
+    bool getPaymentStatus() { return isCompleted; }
+    bool getRefundStatus() { return isRefunded; }
+};
+
+// External payment provider. `charge` may block for a network round trip.
+class PaymentGateway
+{
+public:
+    virtual ~PaymentGateway() = default;
+    virtual bool charge(const string& idempotencyKey, double amount, const string& method) = 0;
+    // Returns a successful charge made under idempotencyKey
+    virtual bool refund(const string& idempotencyKey, double amount) = 0;
+};
+
+// Local stand-in for a real gateway with configurable latency and failure rate.
+// It counts charges and refunds per idempotency key so double charging, or a
+// charge that was never refunded, can be detected.
+class StubPaymentGateway : public PaymentGateway
+{
+private:
+    chrono::microseconds latency;
+    double failureRate;
+    mutex lock;
+    mt19937 rng;
+    unordered_map<string, int> chargesByKey;
+    unordered_map<string, int> refundsByKey;
+
+public:
+    StubPaymentGateway(chrono::microseconds latency, double failureRate, unsigned seed = 1)
+        : latency(latency), failureRate(failureRate), rng(seed) {}
+    
+    bool charge(const string& idempotencyKey, double /*amount*/, const string& /*method*/) override {
+        this_thread::sleep_for(latency);
+        lock_guard<mutex> guard(lock);
+        if (uniform_real_distribution<double>(0.0, 1.0)(rng) < failureRate) {
+            return false;
+        }
+        chargesByKey[idempotencyKey]++;
+        return true;
+    }
+    
+    bool refund(const string& idempotencyKey, double /*amount*/) override {
+        this_thread::sleep_for(latency);
+        lock_guard<mutex> guard(lock);
+        refundsByKey[idempotencyKey]++;
+        return true;
+    }
+    
+    int getChargeCount(const string& idempotencyKey) {
+        lock_guard<mutex> guard(lock);
+        auto it = chargesByKey.find(idempotencyKey);
+        return it == chargesByKey.end() ? 0 : it->second;
+    }
+    
+    int getRefundCount(const string& idempotencyKey) {
+        lock_guard<mutex> guard(lock);
+        auto it = refundsByKey.find(idempotencyKey);
+        return it == refundsByKey.end() ? 0 : it->second;
+    }
+};
+
+// Fixed-capacity blocking FIFO shared by producers and a worker pool
+template <typename T>
+class BoundedQueue
+{
+private:
+    deque<T> items;
+    size_t capacity;
+    bool closed = false;
+    mutex lock;
+    condition_variable notEmpty;
+    condition_variable notFull;
+
+public:
+    BoundedQueue(size_t capacity) : capacity(capacity) {}
     
-    // Getters
-    int getUserID() { return userID; }
-    string getName() { return name; }
-    string getEmail() { return email; }
-    string getPhoneNumber() { return phoneNumber; }
+    // Blocks while the queue is full; false once the queue is closed
+    bool push(T item) {
+        unique_lock<mutex> guard(lock);
+        notFull.wait(guard, [this]() { return closed || items.size() < capacity; });
+        if (closed) {
+            return false;
+        }
+        items.push_back(move(item));
+        notEmpty.notify_one();
+        return true;
+    }
+    
+    // Blocks while the queue is empty; false once closed and drained
+    bool pop(T& item) {
+        unique_lock<mutex> guard(lock);
+        notEmpty.wait(guard, [this]() { return closed || !items.empty(); });
+        if (items.empty()) {
+            return false;
+        }
+        item = move(items.front());
+        items.pop_front();
+        notFull.notify_one();
+        return true;
+    }
+    
+    void close() {
+        lock_guard<mutex> guard(lock);
+        closed = true;
+        notEmpty.notify_all();
+        notFull.notify_all();
+    }
 };
 
-class Payment
+// Asynchronous payments: callers enqueue, a worker pool talks to the gateway.
+// Each idempotency key is charged at most once; a retry with the same key
+// waits for (or replays) the first attempt's outcome instead of charging again.
+class PaymentPipeline
 {
+public:
+    typedef function<void(bool)> Callback;
+
 private:
-    int paymentID;
-    double amount;
-    string paymentMethod;
-    string paymentDate;
-    bool isCompleted;
+    enum class Outcome { Pending, Succeeded, Failed };
+    
+    struct PaymentJob {
+        string idempotencyKey;
+        double amount;
+        string method;
+    };
+    
+    struct KeyState {
+        Outcome outcome;
+        vector<Callback> waiters;
+    };
+    
+    PaymentGateway* gateway;
+    BoundedQueue<PaymentJob> queue;
+    vector<thread> workers;
+    mutex stateLock;
+    unordered_map<string, KeyState> keys;
+    deque<pair<chrono::steady_clock::time_point, string>> settledKeys; // oldest first
+    chrono::steady_clock::duration retention;
+    
+    // Forgets keys settled more than `retention` ago, so the table holds only
+    // the recent window; a retry after that is treated as a new payment
+    void expireSettled() {
+        auto cutoff = chrono::steady_clock::now() - retention;
+        while (!settledKeys.empty() && settledKeys.front().first <= cutoff) {
+            keys.erase(settledKeys.front().second);
+            settledKeys.pop_front();
+        }
+    }
+    
+    // Runs every waiter for the key; the outcome is published only once no
+    // waiter is left, so a retry never races with the first callback.
+    void settle(const string& idempotencyKey, bool ok) {
+        while (true) {
+            vector<Callback> waiters;
+            {
+                lock_guard<mutex> guard(stateLock);
+                KeyState& state = keys[idempotencyKey];
+                if (state.waiters.empty()) {
+                    state.outcome = ok ? Outcome::Succeeded : Outcome::Failed;
+                    settledKeys.emplace_back(chrono::steady_clock::now(), idempotencyKey);
+                    return;
+                }
+                waiters.swap(state.waiters);
+            }
+            for (Callback& done : waiters) {
+                done(ok);
+            }
+        }
+    }
+    
+    void workerLoop() {
+        PaymentJob job;
+        while (queue.pop(job)) {
+            settle(job.idempotencyKey, gateway->charge(job.idempotencyKey, job.amount, job.method));
+        }
+    }
 
 public:
-    Payment(int id, double amt, string method, string date) 
-        : paymentID(id), amount(amt), paymentMethod(method), paymentDate(date), isCompleted(false) {}
+    // Settled keys are remembered for `retention`, long enough for any client retry
+    PaymentPipeline(PaymentGateway* gateway, int workerCount, size_t queueCapacity,
+                    chrono::steady_clock::duration retention = chrono::hours(24))
+        : gateway(gateway), queue(queueCapacity), retention(retention) {
+        for (int i = 0; i < workerCount; i++) {
+            workers.emplace_back(&PaymentPipeline::workerLoop, this);
+        }
+    }
     
-    bool processPayment() {
-        // Simulate payment processing
-        cout << "Processing payment of $" << amount << " via " << paymentMethod << endl;
-        isCompleted = true;
-        return true;
+    ~PaymentPipeline() {
+        shutdown();
     }
     
-    // Getters
-    int getPaymentID() { return paymentID; }
-    double getAmount() { return amount; }
-    bool getPaymentStatus() { return isCompleted; }
+    // `done` runs on a worker thread, or inline if the key is already settled
+    void submit(const string& idempotencyKey, double amount, const string& method, Callback done) {
+        unique_lock<mutex> guard(stateLock);
+        expireSettled();
+        auto it = keys.find(idempotencyKey);
+        if (it != keys.end()) {
+            if (it->second.outcome == Outcome::Pending) {
+                it->second.waiters.push_back(move(done));
+                return;
+            }
+            bool ok = it->second.outcome == Outcome::Succeeded;
+            guard.unlock();
+            done(ok);
+            return;
+        }
+        keys[idempotencyKey] = KeyState{Outcome::Pending, {move(done)}};
+        guard.unlock();
+        
+        if (!queue.push({idempotencyKey, amount, method})) {
+            settle(idempotencyKey, false); // pipeline already shut down
+        }
+    }
+    
+    // Refunds a settled charge; blocks for the gateway round trip on the caller's thread
+    bool refund(const string& idempotencyKey, double amount) {
+        return gateway->refund(idempotencyKey, amount);
+    }
+    
+    // Keys currently remembered, pending or settled
+    size_t getTrackedKeyCount() {
+        lock_guard<mutex> guard(stateLock);
+        return keys.size();
+    }
+    
+    // Drains queued payments and stops the workers
+    void shutdown() {
+        queue.close();
+        for (thread& worker : workers) {
+            if (worker.joinable()) {
+                worker.join();
+            }
+        }
+    }
 };
 
 class Booking
@@ -452,59 +2494,131 @@ private:
     int bookingID;
     User* user;
     Show* show;
-    vector<Seat*> bookedSeats;
+    SeatIndexList seatIndices; // seat ordinals within the show
+    PriceQuote quote;          // prices locked in when the booking was created
     Payment* payment;
+    long long holdID = 0;      // nonzero between holdSeats and commit/release
     BookingStatus status;
     string bookingDate;
     double totalAmount;
+    
+    // Both confirm paths report Confirmed only once the payment is durable;
+    // false if the journal failed before it was
+    bool journalPayment() {
+        BookingJournal* journal = show->getJournal();
+        return journal == nullptr || journal->waitDurable(journal->append(JournalOp::Pay, show->getShowID(), bookingID));
+    }
 
 public:
-    Booking(int id, User* user, Show* show, vector<int> seatIDs, string date) 
-        : bookingID(id), user(user), show(show), bookingDate(date), payment(nullptr) {
+    Booking(int id, User* user, Show* show, const vector<int>& seatIDs, string date) 
+        : bookingID(id), user(user), show(show), payment(nullptr), bookingDate(date) {
         
         status = BookingStatus::Pending;
         
-        // Get seat objects from seat IDs
+        // Resolve seat IDs to ordinals; unknown IDs are skipped
         for (int seatID : seatIDs) {
-            for (Seat* seat : show->getScreen()->getAllSeats()) {
-                if (seat->getSeatID() == seatID) {
-                    bookedSeats.push_back(seat);
-                    break;
-                }
+            int ordinal = show->getSeatOrdinal(seatID);
+            if (ordinal != -1) {
+                seatIndices.push_back(ordinal);
             }
         }
         
-        totalAmount = show->calculateTotalPrice(seatIDs);
+        quote = show->quote(seatIndices);
+        totalAmount = quote.total;
+    }
+    
+    // For seats picked by Show::findBestAvailable
+    Booking(int id, User* user, Show* show, const SeatIndexList& seats, string date) 
+        : bookingID(id), user(user), show(show), seatIndices(seats), payment(nullptr), bookingDate(date) {
+        status = BookingStatus::Pending;
+        quote = show->quote(seatIndices);
+        totalAmount = quote.total;
     }
     
+    // For seats the show already holds for this user, e.g. a waitlist offer
+    void markSeatsHeld(long long heldUnder) { holdID = heldUnder; }
+    
     bool confirmBooking(string paymentMethod) {
-        vector<int> seatIDs;
-        for (Seat* seat : bookedSeats) {
-            seatIDs.push_back(seat->getSeatID());
+        // Hold the seats and charge only while the hold is ours; book them
+        // only if it still is once payment goes through, else refund
+        if (holdID == 0) {
+            holdID = show->holdSeats(seatIndices);
         }
-        
-        // Try to book seats
-        if (show->bookSeats(seatIDs)) {
-            // Process payment
-            payment = new Payment(bookingID * 100, totalAmount, paymentMethod, bookingDate);
-            if (payment->processPayment()) {
-                status = BookingStatus::Confirmed;
-                cout << "Booking confirmed! Booking ID: " << bookingID << endl;
-                return true;
+        if (holdID != 0) {
+            long long heldUnder = holdID;
+            holdID = 0;
+            if (show->isHeldBy(seatIndices, heldUnder)) {
+                payment = new Payment(bookingID * 100, totalAmount, paymentMethod, bookingDate);
+                if (payment->processPayment()) {
+                    if (show->commitHold(seatIndices, heldUnder)) {
+                        if (journalPayment()) {
+                            status = BookingStatus::Confirmed;
+                            cout << "Booking confirmed! Booking ID: " << bookingID << endl;
+                            return true;
+                        }
+                        show->releaseSeats(seatIndices); // a restart would not know of this booking
+                    }
+                    payment->refund();
+                }
             }
+            show->releaseHold(seatIndices, heldUnder);
         }
         
         status = BookingStatus::Cancelled;
         return false;
     }
     
+    // Holds the seats and hands the charge to the pipeline. The seats become
+    // Booked only when the gateway succeeds and the hold is still ours; on
+    // failure the hold is released, and a charge whose hold lapsed meanwhile
+    // is refunded. `done` runs on a pipeline worker; read the status only
+    // after it fires. Calling this again for the same booking never charges twice.
+    void confirmBookingAsync(PaymentPipeline& pipeline, string paymentMethod, function<void(bool)> done) {
+        if (payment == nullptr) {
+            if (holdID == 0) {
+                holdID = show->holdSeats(seatIndices);
+            }
+            if (holdID == 0 || !show->isHeldBy(seatIndices, holdID)) {
+                if (holdID != 0) {
+                    show->releaseHold(seatIndices, holdID);
+                    holdID = 0;
+                }
+                status = BookingStatus::Cancelled;
+                done(false);
+                return;
+            }
+            payment = new Payment(bookingID * 100, totalAmount, paymentMethod, bookingDate,
+                                  "booking-" + to_string(bookingID));
+        }
+        pipeline.submit(payment->getIdempotencyKey(), totalAmount, paymentMethod,
+            [this, done, &pipeline](bool ok) {
+                if (holdID != 0) {
+                    if (ok) {
+                        payment->markCompleted();
+                        ok = show->commitHold(seatIndices, holdID);
+                        if (ok && !journalPayment()) {
+                            show->releaseSeats(seatIndices); // a restart would not know of this booking
+                            ok = false;
+                        }
+                        if (!ok && pipeline.refund(payment->getIdempotencyKey(), totalAmount)) {
+                            payment->markRefunded();
+                        }
+                    }
+                    if (!ok) {
+                        show->releaseHold(seatIndices, holdID);
+                    }
+                    holdID = 0;
+                } else {
+                    ok = status == BookingStatus::Confirmed; // settled by an earlier call
+                }
+                status = ok ? BookingStatus::Confirmed : BookingStatus::Cancelled;
+                done(ok);
+            });
+    }
+    
     void cancelBooking() {
         if (status == BookingStatus::Confirmed) {
-            vector<int> seatIDs;
-            for (Seat* seat : bookedSeats) {
-                seatIDs.push_back(seat->getSeatID());
-            }
-            show->releaseSeats(seatIDs);
+            show->releaseSeats(seatIndices);
             status = BookingStatus::Cancelled;
             cout << "Booking cancelled successfully!" << endl;
         }
@@ -514,9 +2628,18 @@ public:
     int getBookingID() { return bookingID; }
     User* getUser() { return user; }
     Show* getShow() { return show; }
-    vector<Seat*> getBookedSeats() { return bookedSeats; }
+    const SeatIndexList& getSeatIndices() { return seatIndices; }
+    vector<Seat*> getBookedSeats() {
+        vector<Seat*> bookedSeats;
+        for (int ordinal : seatIndices) {
+            bookedSeats.push_back(show->getSeatAt(ordinal));
+        }
+        return bookedSeats;
+    }
     BookingStatus getStatus() { return status; }
+    Payment* getPayment() { return payment; }
     double getTotalAmount() { return totalAmount; }
+    const PriceQuote& getQuote() { return quote; }
     
     void printBookingDetails() {
         cout << "\n=== Booking Details ===" << endl;
@@ -525,7 +2648,8 @@ public:
         cout << "Movie: " << show->getMovie().getMovieName() << endl;
         cout << "Show Time: " << show->getStartTime() << " - " << show->getEndTime() << endl;
         cout << "Seats: ";
-        for (Seat* seat : bookedSeats) {
+        for (int ordinal : seatIndices) {
+            Seat* seat = show->getSeatAt(ordinal);
             cout << "Row " << seat->getSeatRow() << " Seat " << seat->getSeatNumber() << " ";
         }
         cout << endl;
@@ -533,4 +2657,923 @@ public:
         cout << "Status: " << (status == BookingStatus::Confirmed ? "Confirmed" : 
                               status == BookingStatus::Cancelled ? "Cancelled" : "Pending") << endl;
     }
-};
\ No newline at end of file
+};
+
+// ---------------------------------------------------------------------------
+// Benchmarks and checks (run with --bench)
+// ---------------------------------------------------------------------------
+
+static const SeatCategory allCategories[] = {SeatCategory::Economy, SeatCategory::Silver, SeatCategory::Gold};
+
+void benchmarkBestAvailable() {
+    cout << "\n=== Best-available benchmark (2000-seat hall) ===" << endl;
+    Screen* screen = new Screen(100, 2000);
+    Show* show = new Show(100, "21:00", "23:30", Movie("Benchmark", 120, ""), screen);
+    screen->addShow(show);
+    
+    // Fragment the hall: book roughly half the seats at random
+    mt19937 rng(42);
+    SeatIndexList scattered;
+    for (int ordinal = 0; ordinal < 2000; ordinal++) {
+        if (rng() % 2 == 0) {
+            scattered.push_back(ordinal);
+        }
+    }
+    show->bookSeats(scattered);
+    
+    const int queries = 200000;
+    SeatIndexList out;
+    int found = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < queries; i++) {
+        found += show->findBestAvailable(1 + i % 4, allCategories[i % 3], out);
+    }
+    double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    cout << "findBestAvailable on half-booked hall: " << us / queries << " us/query (" << found << " hits)" << endl;
+    show->releaseSeats(scattered);
+    
+    // Concurrent: threads book 1-6 seat blocks until the hall is sold out
+    const int threads = 8;
+    vector<thread> workers;
+    vector<long long> calls(threads, 0);
+    vector<double> busyMicros(threads, 0.0);
+    start = chrono::steady_clock::now();
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            mt19937 local(t);
+            SeatIndexList picked;
+            int misses = 0;
+            while (misses < 50) {
+                auto begin = chrono::steady_clock::now();
+                bool ok = show->bookBestAvailable(1 + local() % 6, allCategories[local() % 3], picked);
+                busyMicros[t] += chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count();
+                calls[t]++;
+                misses = ok ? 0 : misses + 1;
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    double wall = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    long long totalCalls = accumulate(calls.begin(), calls.end(), 0LL);
+    double totalBusy = accumulate(busyMicros.begin(), busyMicros.end(), 0.0);
+    cout << threads << " threads sold out the hall in " << wall << " ms, " << totalBusy / totalCalls
+         << " us/bookBestAvailable, " << show->getAvailableSeats().size() << " seats left" << endl;
+}
+
+void benchmarkShowCatalog() {
+    cout << "\n=== Show catalog benchmark (5k theatres, 100k shows) ===" << endl;
+    const City cities[] = {City::Delhi, City::Saharanpur, City::Indore};
+    const int theatreCount = 5000, showsPerTheatre = 20, movieCount = 200;
+    const string dates[] = {"2024-06-01", "2024-06-02", "2024-06-03", "2024-06-04", "2024-06-05"};
+    
+    vector<Movie> movies;
+    for (int m = 0; m < movieCount; m++) {
+        movies.push_back(Movie("Movie " + to_string(m), 120, "Cast " + to_string(m), "Drama"));
+    }
+    
+    TheatreController theatreController;
+    mt19937 rng(7);
+    auto buildStart = chrono::steady_clock::now();
+    for (int t = 0; t < theatreCount; t++) {
+        City city = cities[t % 3];
+        Theatre* theatre = new Theatre(t + 1, "Theatre " + to_string(t), "Address", city);
+        theatreController.addTheatre(theatre, city);
+        for (int i = 0; i < showsPerTheatre; i++) {
+            int minute = 9 * 60 + (int)(rng() % (14 * 60));
+            char start[6];
+            snprintf(start, sizeof(start), "%02d:%02d", minute / 60, minute % 60);
+            Show* show = new Show(t * showsPerTheatre + i, start, "", movies[rng() % movieCount], nullptr,
+                                  dates[rng() % 5]);
+            theatreController.addShow(theatre, show);
+        }
+    }
+    double buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - buildStart).count();
+    cout << "Indexed " << theatreCount * showsPerTheatre << " shows in " << buildMs << " ms" << endl;
+    
+    // Indexed lookup
+    const int queries = 100000;
+    size_t hits = 0;
+    auto start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        const string& name = movies[q % movieCount].getMovieName();
+        hits += theatreController.getShowsForMovie(cities[q % 3], name, dates[q % 5]).size();
+    }
+    double indexedUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / queries;
+    
+    // Scan baseline: walk every theatre in the city, filter and sort
+    const int scanQueries = 100;
+    size_t scanHits = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < scanQueries; q++) {
+        const string& name = movies[q % movieCount].getMovieName();
+        vector<pair<string, Show*>> found;
+        for (Theatre* theatre : theatreController.getTheatresByCity(cities[q % 3])) {
+            for (Show* show : theatre->getShowsByMovie(name)) {
+                if (show->getShowDate() == dates[q % 5]) {
+                    found.push_back({show->getStartTime(), show});
+                }
+            }
+        }
+        sort(found.begin(), found.end());
+        scanHits += found.size();
+    }
+    double scanUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / scanQueries;
+    
+    cout << "Indexed lookup: " << indexedUs << " us/query (avg " << (double)hits / queries << " shows)" << endl;
+    cout << "Theatre scan:   " << scanUs << " us/query (avg " << (double)scanHits / scanQueries << " shows)" << endl;
+    
+    int found = 0;
+    start = chrono::steady_clock::now();
+    for (int q = 0; q < queries; q++) {
+        found += theatreController.getTheatreByID(1 + (q * 7919) % theatreCount)->getTheatreID() > 0;
+    }
+    cout << "getTheatreByID: " << chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / queries
+         << " ns/lookup (" << found << " found)" << endl;
+}
+
+static double simulatedSeconds = 0.0;
+static double simulatedClock() { return simulatedSeconds; }
+
+// Blockbuster release: 1M booking attempts against one 2000-seat show, front
+// loaded towards the moment bookings open, with a fifth of the successful
+// bookings cancelled up to 30 minutes later.
+void simulateSurgePricing() {
+    cout << "\n=== Surge pricing simulation (1M booking attempts) ===" << endl;
+    Screen* screen = new Screen(102, 2000);
+    Show* show = new Show(102, "00:01", "03:00", Movie("Blockbuster", 180, ""), screen);
+    screen->addShow(show);
+    show->setPricingClock(simulatedClock);
+    
+    const int attempts = 1000000;
+    const double releaseWindow = 6 * 3600.0;
+    mt19937 rng(2024);
+    uniform_real_distribution<double> unit(0.0, 1.0);
+    
+    struct PendingCancel {
+        double at;
+        SeatIndexList seats;
+        bool operator>(const PendingCancel& other) const { return at > other.at; }
+    };
+    priority_queue<PendingCancel, vector<PendingCancel>, greater<PendingCancel>> cancels;
+    
+    long long booked = 0, seatsSold = 0;
+    double revenue = 0.0, maxPaid[3] = {}, paidSum[3] = {};
+    long long paidCount[3] = {};
+    SeatIndexList picked;
+    PriceQuote quote;
+    
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < attempts; i++) {
+        double progress = (double)i / attempts;
+        simulatedSeconds = releaseWindow * progress * progress;
+        while (!cancels.empty() && cancels.top().at <= simulatedSeconds) {
+            show->releaseSeats(cancels.top().seats);
+            cancels.pop();
+        }
+        
+        int count = 1 + rng() % 4;
+        SeatCategory category = allCategories[rng() % 3];
+        if (show->bookBestAvailable(count, category, picked, &quote)) {
+            booked++;
+            seatsSold += count;
+            double price = quote.categoryPrice[(int)category];
+            revenue += quote.total;
+            paidSum[(int)category] += price;
+            paidCount[(int)category]++;
+            maxPaid[(int)category] = max(maxPaid[(int)category], price);
+            if (unit(rng) < 0.2) {
+                cancels.push({simulatedSeconds + unit(rng) * 1800.0, picked});
+            }
+        }
+        if ((i + 1) % 200000 == 0) {
+            cout << "t=" << (int)(simulatedSeconds / 60) << "min  Economy/Silver/Gold = "
+                 << show->getCurrentPrice(SeatCategory::Economy) << "/"
+                 << show->getCurrentPrice(SeatCategory::Silver) << "/"
+                 << show->getCurrentPrice(SeatCategory::Gold) << endl;
+        }
+    }
+    double elapsedMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    
+    cout << booked << " bookings (" << seatsSold << " seats) from " << attempts << " attempts, revenue $" << revenue << endl;
+    const char* names[] = {"Economy", "Silver", "Gold"};
+    for (int c = 0; c < 3; c++) {
+        cout << names[c] << ": avg paid $" << (paidCount[c] ? paidSum[c] / paidCount[c] : 0.0)
+             << ", max $" << maxPaid[c] << endl;
+    }
+    cout << elapsedMs << " ms total, " << elapsedMs * 1e6 / attempts << " ns/attempt" << endl;
+}
+
+// Bookings/sec and seat-hold duration through the async payment pipeline at
+// several gateway latencies. Every booking is confirmed twice to exercise
+// idempotency: no key may be charged more than once.
+void benchmarkPaymentPipeline() {
+    cout << "\n=== Payment pipeline benchmark (32 workers, 5% gateway failures) ===" << endl;
+    const int latenciesMicros[] = {0, 1000, 5000, 20000};
+    const int bookingCount = 600;
+    
+    for (int round = 0; round < 4; round++) {
+        Screen* screen = new Screen(200 + round, 2000);
+        Show* show = new Show(200 + round, "20:00", "23:00", Movie("Pipeline", 180, ""), screen);
+        screen->addShow(show);
+        User* user = new User(1000, "Load", "load@example.com", "0");
+        
+        StubPaymentGateway gateway(chrono::microseconds(latenciesMicros[round]), 0.05, round + 1);
+        PaymentPipeline pipeline(&gateway, 32, 256);
+        
+        vector<Booking*> bookings;
+        vector<chrono::steady_clock::time_point> heldAt(bookingCount), settledAt(bookingCount);
+        atomic<int> pending(0);
+        mt19937 rng(round);
+        
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < bookingCount; i++) {
+            SeatIndexList seats;
+            if (!show->findBestAvailable(1 + rng() % 4, allCategories[rng() % 3], seats)) {
+                break;
+            }
+            Booking* booking = new Booking(10000 + i, user, show, seats, "2024-06-01");
+            bookings.push_back(booking);
+            pending += 2;
+            heldAt[i] = chrono::steady_clock::now();
+            booking->confirmBookingAsync(pipeline, "Card", [&, i](bool) {
+                settledAt[i] = chrono::steady_clock::now();
+                pending--;
+            });
+            booking->confirmBookingAsync(pipeline, "Card", [&](bool) { pending--; }); // client retry
+        }
+        while (pending > 0) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+        double wallSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        int confirmed = 0, doubleCharged = 0, confirmedSeats = 0;
+        vector<double> holdMillis;
+        for (int i = 0; i < (int)bookings.size(); i++) {
+            if (bookings[i]->getStatus() == BookingStatus::Confirmed) {
+                confirmed++;
+                confirmedSeats += bookings[i]->getSeatIndices().size();
+            }
+            doubleCharged += gateway.getChargeCount("booking-" + to_string(10000 + i)) > 1;
+            holdMillis.push_back(chrono::duration<double, milli>(settledAt[i] - heldAt[i]).count());
+        }
+        sort(holdMillis.begin(), holdMillis.end());
+        bool seatsConsistent = (int)show->getBookedSeats().size() == confirmedSeats;
+        
+        cout << "latency " << latenciesMicros[round] / 1000.0 << " ms: "
+             << bookings.size() / wallSeconds << " bookings/s, hold p50 "
+             << holdMillis[holdMillis.size() / 2] << " ms, p95 " << holdMillis[holdMillis.size() * 95 / 100]
+             << " ms, " << confirmed << "/" << bookings.size() << " confirmed, "
+             << doubleCharged << " double charges, seat state " << (seatsConsistent ? "consistent" : "INCONSISTENT") << endl;
+    }
+    
+    // Sustained traffic: settled keys leave the table once the retention window passes
+    StubPaymentGateway gateway(chrono::microseconds(0), 0.0, 7);
+    PaymentPipeline pipeline(&gateway, 4, 256, chrono::milliseconds(50));
+    atomic<int> pending(0);
+    auto payOnce = [&](const string& key) {
+        pending++;
+        pipeline.submit(key, 100.0, "Card", [&](bool) { pending--; });
+        while (pending > 0) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    };
+    for (int i = 0; i < 5000; i++) {
+        payOnce("burst-" + to_string(i));
+    }
+    size_t trackedAfterBurst = pipeline.getTrackedKeyCount();
+    payOnce("burst-4999"); // retry inside the window: answered from the table
+    bool retryDeduplicated = gateway.getChargeCount("burst-4999") == 1;
+    this_thread::sleep_for(chrono::milliseconds(60));
+    payOnce("after-window");
+    size_t trackedAfterWindow = pipeline.getTrackedKeyCount();
+    cout << (retryDeduplicated && trackedAfterWindow == 1 ? "PASS" : "FAIL")
+         << ": idempotency keys " << trackedAfterBurst << " after 5000 payments, " << trackedAfterWindow
+         << " once the 50 ms window passed; retry inside it " << (retryDeduplicated ? "not charged" : "CHARGED") << endl;
+}
+
+// 100k users wait on a sold-out 2000-seat show, then a burst of 500
+// cancellations frees seats; measures matching cost per released seat.
+void benchmarkWaitlist() {
+    cout << "\n=== Waitlist benchmark (100k waiting, 500 cancellations) ===" << endl;
+    Screen* screen = new Screen(300, 2000);
+    Show* show = new Show(300, "19:00", "22:00", Movie("Sold Out", 180, ""), screen);
+    screen->addShow(show);
+    
+    vector<SeatIndexList> sold;
+    SeatIndexList picked;
+    mt19937 rng(31);
+    for (SeatCategory category : allCategories) {
+        while (show->bookBestAvailable(1 + rng() % 4, category, picked) ||
+               show->bookBestAvailable(1, category, picked)) {
+            sold.push_back(picked);
+        }
+    }
+    
+    const int waiters = 100000;
+    long long offersMade = 0, seatsOffered = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < waiters; i++) {
+        show->joinWaitlist(i, 1 + rng() % 6, allCategories[rng() % 3], [&](const SeatIndexList& offered, long long) {
+            offersMade++;
+            seatsOffered += offered.size();
+        });
+    }
+    double joinNs = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / waiters;
+    
+    shuffle(sold.begin(), sold.end(), rng);
+    long long seatsReleased = 0;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < 500; i++) {
+        show->releaseSeats(sold[i]);
+        seatsReleased += sold[i].size();
+    }
+    double burstUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+    
+    cout << "join: " << joinNs << " ns/user" << endl;
+    cout << "burst: " << seatsReleased << " seats released in " << burstUs << " us ("
+         << burstUs * 1000 / seatsReleased << " ns/seat), " << offersMade << " offers covering "
+         << seatsOffered << " seats, " << show->getWaitlistSize() << " still waiting" << endl;
+    
+    // An offer that lapses and is re-offered cannot be committed by its first holder
+    Screen* smallScreen = new Screen(301, 20);
+    Show* small = new Show(301, "19:00", "22:00", Movie("Sold Out", 180, ""), smallScreen);
+    smallScreen->addShow(small);
+    simulatedSeconds = 0.0;
+    small->setPricingClock(simulatedClock);
+    small->setWaitlistOfferSeconds(60.0);
+    SeatIndexList lastGold;
+    while (small->bookBestAvailable(1, SeatCategory::Gold, picked)) {
+        lastGold = picked;
+    }
+    vector<pair<SeatIndexList, long long>> offers;
+    for (int user = 0; user < 2; user++) {
+        small->joinWaitlist(user, 1, SeatCategory::Gold, [&](const SeatIndexList& offered, long long holdID) {
+            offers.push_back({offered, holdID});
+        });
+    }
+    small->releaseSeats(lastGold);
+    simulatedSeconds = 120.0;
+    small->expireHolds();
+    User* waiter = new User(3000, "Waiter", "waiter@example.com", "0");
+    bool lapsedCharged = false;
+    if (offers.size() == 2) {
+        Booking lapsed(3000, waiter, small, offers[0].first, "2024-06-01");
+        lapsed.markSeatsHeld(offers[0].second);
+        lapsedCharged = lapsed.confirmBooking("UPI") || lapsed.getPayment() != nullptr;
+    }
+    bool lapsedCommitted = offers.size() == 2 && small->commitHold(offers[0].first, offers[0].second);
+    bool currentCommitted = offers.size() == 2 && small->commitHold(offers[1].first, offers[1].second);
+    cout << (!lapsedCommitted && !lapsedCharged && currentCommitted ? "PASS" : "FAIL")
+         << ": lapsed offer rejected without a charge, re-offered hold committed" << endl;
+    
+    // The hold lapses while the gateway is charging: the charge is refunded
+    Screen* lapseScreen = new Screen(302, 20);
+    Show* lapse = new Show(302, "19:00", "22:00", Movie("Sold Out", 180, ""), lapseScreen);
+    lapseScreen->addShow(lapse);
+    simulatedSeconds = 0.0;
+    lapse->setPricingClock(simulatedClock);
+    lapse->setWaitlistOfferSeconds(60.0);
+    while (lapse->bookBestAvailable(1, SeatCategory::Gold, picked)) {
+        lastGold = picked;
+    }
+    pair<SeatIndexList, long long> offer;
+    lapse->joinWaitlist(0, 1, SeatCategory::Gold, [&](const SeatIndexList& offered, long long holdID) {
+        offer = {offered, holdID};
+    });
+    lapse->releaseSeats(lastGold);
+    int bookedBefore = lapse->getBookedSeats().size();
+    StubPaymentGateway gateway(chrono::milliseconds(50), 0.0);
+    PaymentPipeline pipeline(&gateway, 2, 16);
+    Booking slow(3001, waiter, lapse, offer.first, "2024-06-01");
+    slow.markSeatsHeld(offer.second);
+    atomic<bool> settled(false);
+    bool confirmed = true;
+    slow.confirmBookingAsync(pipeline, "Card", [&](bool ok) {
+        confirmed = ok;
+        settled = true;
+    });
+    simulatedSeconds = 120.0;
+    lapse->expireHolds(); // the charge is still in flight
+    while (!settled) {
+        this_thread::sleep_for(chrono::milliseconds(1));
+    }
+    bool refunded = gateway.getChargeCount("booking-3001") == 1 && gateway.getRefundCount("booking-3001") == 1
+                 && slow.getPayment()->getRefundStatus();
+    bool seatsFree = (int)lapse->getBookedSeats().size() == bookedBefore;
+    cout << (!confirmed && slow.getStatus() == BookingStatus::Cancelled && refunded && seatsFree ? "PASS" : "FAIL")
+         << ": hold lapsed during payment, booking cancelled and charge refunded" << endl;
+}
+
+// Journal append throughput (fire-and-forget and wait-for-durable), then
+// recovery of 1M seat-state changes from the journal alone and from a snapshot.
+void benchmarkJournal() {
+    cout << "\n=== Booking journal benchmark ===" << endl;
+    const string prefix = "bms_bench";
+    remove((prefix + ".journal").c_str());
+    remove((prefix + ".snapshot").c_str());
+    
+    const int showCount = 10, seatsPerShow = 2000, changes = 1000000, threads = 4;
+    unordered_map<uint32_t, vector<SeatStatus>> expected;
+    {
+        BookingJournal journal(prefix);
+        journal.recover();
+        
+        // One writer per show group so the expected final state is deterministic
+        vector<unordered_map<uint32_t, vector<SeatStatus>>> perThread(threads);
+        vector<thread> writers;
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++) {
+            writers.emplace_back([&, t]() {
+                mt19937 rng(t);
+                const JournalOp ops[] = {JournalOp::Book, JournalOp::Release, JournalOp::Hold, JournalOp::Expire};
+                const SeatStatus after[] = {SeatStatus::Booked, SeatStatus::Available, SeatStatus::Held, SeatStatus::Available};
+                for (int i = 0; i < changes / threads; i++) {
+                    int show = t + threads * (rng() % ((showCount + threads - 1 - t) / threads));
+                    int seat = rng() % seatsPerShow;
+                    int op = rng() % 4;
+                    journal.append(ops[op], show, seat);
+                    vector<SeatStatus>& seats = perThread[t][show];
+                    if ((int)seats.size() <= seat) seats.resize(seat + 1, SeatStatus::Available);
+                    seats[seat] = after[op];
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        journal.waitDurable(changes);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "async append: " << changes / seconds / 1e6 << " M records/s, "
+             << journal.getBatchCount() << " fsync batches" << endl;
+        for (auto& m : perThread) expected.insert(m.begin(), m.end());
+        
+        // Synchronous commits: each writer waits for its record to be durable
+        const int syncPerThread = 500;
+        long long batchesBefore = journal.getBatchCount();
+        writers.clear();
+        start = chrono::steady_clock::now();
+        for (int t = 0; t < threads; t++) {
+            writers.emplace_back([&, t]() {
+                for (int i = 0; i < syncPerThread; i++) {
+                    int show = showCount + t; // separate shows, keeps `expected` untouched
+                    journal.waitDurable(journal.append(JournalOp::Pay, show, i));
+                }
+            });
+        }
+        for (auto& w : writers) w.join();
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        long long syncBatches = journal.getBatchCount() - batchesBefore;
+        cout << "durable append: " << threads * syncPerThread / seconds << " commits/s, "
+             << (double)threads * syncPerThread / syncBatches << " records per fsync" << endl;
+    } // "crash": journal closed without a snapshot
+    
+    auto verify = [&](unordered_map<uint32_t, vector<SeatStatus>>& recovered) {
+        for (auto& show : expected) {
+            vector<SeatStatus>& got = recovered[show.first];
+            for (size_t seat = 0; seat < show.second.size(); seat++) {
+                SeatStatus have = seat < got.size() ? got[seat] : SeatStatus::Available;
+                if (have != show.second[seat]) return false;
+            }
+        }
+        return true;
+    };
+    
+    {
+        BookingJournal journal(prefix);
+        auto start = chrono::steady_clock::now();
+        auto recovered = journal.recover();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "recover " << changes << " changes from journal: " << ms << " ms, state "
+             << (verify(recovered) ? "matches" : "MISMATCH") << endl;
+        journal.compact();
+    }
+    {
+        BookingJournal journal(prefix);
+        auto start = chrono::steady_clock::now();
+        auto recovered = journal.recover();
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "recover from snapshot: " << ms << " ms, state "
+             << (verify(recovered) ? "matches" : "MISMATCH") << endl;
+    }
+    remove((prefix + ".journal").c_str());
+    remove((prefix + ".snapshot").c_str());
+    
+    // A snapshot that cannot be written leaves the journal as it was
+    string tempPath = prefix + ".snapshot.tmp";
+    mkdir(tempPath.c_str(), 0755); // the temp file cannot be created over a directory
+    bool compacted = true, keptDurable = false, keptAll = false;
+    {
+        BookingJournal journal(prefix);
+        journal.recover();
+        uint64_t lastLSN = 0;
+        for (int seat = 0; seat < 100; seat++) {
+            lastLSN = journal.append(JournalOp::Book, 1, seat);
+        }
+        compacted = journal.compact();
+        keptDurable = journal.waitDurable(lastLSN);
+    }
+    rmdir(tempPath.c_str());
+    {
+        BookingJournal journal(prefix);
+        auto recovered = journal.recover();
+        keptAll = count(recovered[1].begin(), recovered[1].end(), SeatStatus::Booked) == 100;
+    }
+    cout << (!compacted && keptDurable && keptAll ? "PASS" : "FAIL")
+         << ": failed snapshot kept all 100 journaled bookings" << endl;
+    
+    // A full disk (here a file size limit) is reported to waiters, not thrown
+    rlimit saved, capped;
+    getrlimit(RLIMIT_FSIZE, &saved);
+    capped = saved;
+    capped.rlim_cur = 64 * 1024;
+    signal(SIGXFSZ, SIG_IGN); // write() fails with EFBIG instead of killing the process
+    bool reported = false;
+    string failure;
+    {
+        BookingJournal journal(prefix);
+        journal.recover();
+        setrlimit(RLIMIT_FSIZE, &capped);
+        uint64_t lastLSN = 0;
+        for (int i = 0; i < 10000; i++) {
+            lastLSN = journal.append(JournalOp::Book, 2, i);
+        }
+        reported = !journal.waitDurable(lastLSN);
+        failure = journal.getFailure();
+        setrlimit(RLIMIT_FSIZE, &saved);
+    }
+    signal(SIGXFSZ, SIG_DFL);
+    cout << (reported ? "PASS" : "FAIL") << ": full disk reported to waiters (" << failure << ")" << endl;
+    remove((prefix + ".journal").c_str());
+    remove((prefix + ".snapshot").c_str());
+}
+
+// 50k viewers subscribed to one show while a booker changes seats. Viewer
+// threads drain their queues and apply the deltas to local seat maps.
+void benchmarkSeatMapFeed() {
+    cout << "\n=== Seat-map feed benchmark (50k viewers) ===" << endl;
+    Screen* screen = new Screen(400, 2000);
+    Show* show = new Show(400, "20:00", "23:00", Movie("Premiere", 150, ""), screen);
+    screen->addShow(show);
+    SeatMapFeed feed(4, 256);
+    show->setSeatMapFeed(&feed);
+    
+    const int viewers = 50000, updates = 300, viewerThreads = 2;
+    vector<int> subscriberIDs;
+    uint64_t snapshotVersion;
+    vector<SeatStatus> snapshot = show->getSeatMapSnapshot(snapshotVersion);
+    for (int v = 0; v < viewers; v++) {
+        subscriberIDs.push_back(feed.subscribe());
+    }
+    
+    atomic<bool> done(false);
+    atomic<long long> bytesDelivered(0), framesDelivered(0), resyncs(0);
+    vector<thread> viewerWorkers;
+    vector<vector<SeatStatus>> sampleMaps(viewerThreads, snapshot); // one tracked viewer per thread
+    vector<uint64_t> sampleVersions(viewerThreads, snapshotVersion);
+    for (int t = 0; t < viewerThreads; t++) {
+        viewerWorkers.emplace_back([&, t]() {
+            vector<SeatMapFeed::Frame> frames;
+            bool last = false;
+            while (!last) {
+                last = done;
+                for (int v = t; v < viewers; v += viewerThreads) {
+                    frames.clear();
+                    if (!feed.poll(subscriberIDs[v], frames)) {
+                        resyncs++;
+                        if (v == t) sampleMaps[t] = show->getSeatMapSnapshot(sampleVersions[t]);
+                        continue;
+                    }
+                    long long bytes = 0;
+                    for (auto& frame : frames) {
+                        bytes += frame->size();
+                        if (v == t) SeatMapFeed::applyFrame(*frame, sampleMaps[t], sampleVersions[t]);
+                    }
+                    bytesDelivered += bytes;
+                    framesDelivered += frames.size();
+                }
+            }
+        });
+    }
+    
+    mt19937 rng(33);
+    vector<SeatIndexList> sold;
+    SeatIndexList picked;
+    auto start = chrono::steady_clock::now();
+    for (int u = 0; u < updates; u++) {
+        if (!sold.empty() && rng() % 3 == 0) {
+            show->releaseSeats(sold.back());
+            sold.pop_back();
+        } else if (show->bookBestAvailable(1 + rng() % 4, allCategories[rng() % 3], picked)) {
+            sold.push_back(picked);
+        }
+        this_thread::sleep_for(chrono::milliseconds(2));
+    }
+    this_thread::sleep_for(chrono::milliseconds(200)); // let the last updates fan out
+    done = true;
+    for (auto& w : viewerWorkers) w.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    vector<double> latencies = feed.takeFanOutLatencies();
+    sort(latencies.begin(), latencies.end());
+    uint64_t finalVersion;
+    vector<SeatStatus> truth = show->getSeatMapSnapshot(finalVersion);
+    bool consistent = true;
+    for (auto& local : sampleMaps) {
+        local.resize(truth.size(), SeatStatus::Available);
+        consistent = consistent && local == truth;
+    }
+    cout << finalVersion << " updates, " << framesDelivered << " frames delivered, "
+         << bytesDelivered / seconds / 1e6 << " MB/s to viewers ("
+         << (double)bytesDelivered / max(1LL, framesDelivered.load()) << " bytes/frame), "
+         << resyncs << " resyncs" << endl;
+    if (!latencies.empty()) {
+        cout << "fan-out latency to all " << viewers << " queues: p50 " << latencies[latencies.size() / 2]
+             << " us, p99 " << latencies[latencies.size() * 99 / 100] << " us" << endl;
+    }
+    cout << "sampled viewer maps " << (consistent ? "match" : "DO NOT match") << " the show" << endl;
+    show->setSeatMapFeed(nullptr);
+}
+
+// Screen construction from the compile-time premiere layout versus the
+// runtime-built default layout of the same size
+void benchmarkScreenLayouts() {
+    cout << "\n=== Screen layout benchmark (2000 seats) ===" << endl;
+    const int screens = 1000;
+    long long seats = 0;
+    auto start = chrono::steady_clock::now();
+    for (int i = 0; i < screens; i++) {
+        Screen screen(i, SeatLayout(premiereHall));
+        seats += screen.getAllSeats().size();
+    }
+    double compiledUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / screens;
+    start = chrono::steady_clock::now();
+    for (int i = 0; i < screens; i++) {
+        Screen screen(i, 2000);
+        seats += screen.getAllSeats().size();
+    }
+    double runtimeUs = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count() / screens;
+    cout << "constexpr layout: " << compiledUs << " us/screen, runtime layout: " << runtimeUs
+         << " us/screen (" << seats / (2 * screens) << " seats each)" << endl;
+    
+    // Best-available blocks never straddle an aisle: their columns are consecutive
+    Screen* hall = new Screen(400, SeatLayout(standardHall));
+    Show* show = new Show(400, "18:00", "21:00", Movie("Aisles", 180, ""), hall);
+    hall->addShow(show);
+    bool pass = true;
+    SeatIndexList picked;
+    for (SeatCategory category : allCategories) {
+        while (show->bookBestAvailable(4, category, picked)) {
+            for (int i = 1; i < picked.size(); i++) {
+                if (hall->getLayout()[picked[i]].column != hall->getLayout()[picked[i - 1]].column + 1) {
+                    pass = false;
+                }
+            }
+        }
+    }
+    cout << (pass ? "PASS" : "FAIL") << ": no block of 4 crosses an aisle" << endl;
+}
+
+// Threads race group bookings over four overlapping shows until they sell
+// out. Checks that every seat belongs to at most one committed group and
+// that failed groups leave nothing behind, and reports group latency.
+void benchmarkGroupBooking() {
+    cout << "\n=== Group booking contention (8 threads, 4 shows) ===" << endl;
+    vector<Show*> shows;
+    for (int i = 0; i < 4; i++) {
+        Screen* screen = new Screen(500 + i, 2000);
+        Show* show = new Show(500 + i, "10:00", "13:00", Movie("Offsite", 180, ""), screen);
+        screen->addShow(show);
+        shows.push_back(show);
+    }
+    
+    const int threads = 8, attemptsPerThread = 150;
+    vector<vector<GroupLeg>> committed[threads];
+    vector<double> latencies[threads];
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            mt19937 rng(500 + t);
+            for (int a = 0; a < attemptsPerThread; a++) {
+                vector<int> picks = {0, 1, 2, 3};
+                shuffle(picks.begin(), picks.end(), rng);
+                vector<GroupLeg> legs;
+                for (int l = 0; l < 2 + (int)(rng() % 3); l++) {
+                    GroupLeg leg;
+                    leg.show = shows[picks[l]];
+                    leg.count = 5 + rng() % 56;
+                    leg.category = allCategories[rng() % 3];
+                    legs.push_back(leg);
+                }
+                auto begin = chrono::steady_clock::now();
+                bool ok = Show::bookGroup(legs);
+                latencies[t].push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - begin).count());
+                if (ok) committed[t].push_back(legs);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    
+    bool pass = true;
+    int groups = 0;
+    map<Show*, vector<int>> claims;
+    for (int t = 0; t < threads; t++) {
+        for (auto& legs : committed[t]) {
+            groups++;
+            for (GroupLeg& leg : legs) {
+                if (leg.seats.size() != leg.count) pass = false;
+                for (int ordinal : leg.seats) {
+                    vector<int>& owners = claims[leg.show];
+                    owners.resize(2000, 0);
+                    if (++owners[ordinal] > 1 || leg.show->getSeatStatus(ordinal) != SeatStatus::Booked) pass = false;
+                }
+            }
+        }
+    }
+    for (Show* show : shows) {
+        int claimed = 0;
+        for (int owner : claims[show]) claimed += owner;
+        if ((int)show->getBookedSeats().size() != claimed) pass = false; // a failed group leaked seats
+    }
+    
+    vector<double> all;
+    for (auto& l : latencies) all.insert(all.end(), l.begin(), l.end());
+    sort(all.begin(), all.end());
+    cout << groups << "/" << all.size() << " groups committed, latency p50 " << all[all.size() / 2]
+         << " us, p99 " << all[all.size() * 99 / 100] << " us, max " << all.back() << " us" << endl;
+    cout << (pass ? "PASS: no partial groups, no double-booked seats" : "FAIL") << endl;
+    
+    // A group that cannot fit changes nothing: no feed frame, no price move
+    Screen* screen = new Screen(504, 2000);
+    Show* show = new Show(504, "10:00", "13:00", Movie("Offsite", 180, ""), screen);
+    screen->addShow(show);
+    SeatMapFeed feed;
+    show->setSeatMapFeed(&feed);
+    double priceBefore = show->getCurrentPrice(SeatCategory::Economy);
+    vector<GroupLeg> legs(2);
+    legs[0].show = show;
+    legs[0].count = 300;
+    legs[1].show = show;
+    legs[1].count = 2000; // more Gold seats than the hall has
+    legs[1].category = SeatCategory::Gold;
+    bool failedCleanly = !Show::bookGroup(legs) && feed.getVersion() == 0
+                      && show->getCurrentPrice(SeatCategory::Economy) == priceBefore
+                      && show->getAvailableSeats().size() == 2000;
+    show->setSeatMapFeed(nullptr);
+    cout << (failedCleanly ? "PASS" : "FAIL") << ": failed group left no feed, price or seat trace" << endl;
+}
+
+// What the allocator guarantees: the first pick is the best seat, seats are
+// handed out best first, and under contention no seat goes to two threads and
+// no pair is left unbooked. How the seats split across threads is up to the
+// scheduler (one thread can win them all on a single core), so it is not checked.
+void checkBestAvailableConsistency() {
+    cout << "\n=== Best-available consistency check ===" << endl;
+    Screen* screen = new Screen(101, 2000);
+    Show* show = new Show(101, "21:00", "23:30", Movie("Consistency", 120, ""), screen);
+    screen->addShow(show);
+    bool pass = true;
+    
+    // First pick on an empty hall lands in the middle of the middle Silver row
+    SeatIndexList picked;
+    show->findBestAvailable(4, SeatCategory::Silver, picked);
+    Seat* first = show->getSeatAt(picked[0]);
+    if (first->getSeatRow() != 7 || first->getSeatNumber() != 99) {
+        cout << "FAIL: expected row 7 seat 99, got row " << first->getSeatRow()
+             << " seat " << first->getSeatNumber() << endl;
+        pass = false;
+    }
+    
+    // Earlier requests never get worse seats than later ones
+    const int rowLength = 200;
+    long long previousScore = -1;
+    while (show->bookBestAvailable(2, SeatCategory::Gold, picked)) {
+        Seat* seat = show->getSeatAt(picked[0]);
+        long long score = abs(2 * (seat->getSeatNumber() - 1) + 2 - rowLength)
+                        + 2 * abs(2 * seat->getSeatRow() - (9 + 10));
+        if (score < previousScore) {
+            cout << "FAIL: Gold pair at row " << seat->getSeatRow() << " seat " << seat->getSeatNumber()
+                 << " is better than an earlier allocation" << endl;
+            pass = false;
+        }
+        previousScore = score;
+    }
+    
+    // Threads race for Economy pairs; every seat goes to exactly one thread
+    const int threads = 8;
+    vector<vector<int>> won(threads);
+    vector<thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([&, t]() {
+            SeatIndexList pair;
+            while (show->bookBestAvailable(2, SeatCategory::Economy, pair)) {
+                for (int ordinal : pair) won[t].push_back(ordinal);
+            }
+        });
+    }
+    for (auto& w : workers) w.join();
+    
+    vector<int> owner(2000, -1);
+    size_t total = 0;
+    for (int t = 0; t < threads; t++) {
+        for (int ordinal : won[t]) {
+            if (owner[ordinal] != -1) {
+                cout << "FAIL: seat " << ordinal + 1 << " allocated twice" << endl;
+                pass = false;
+            }
+            owner[ordinal] = t;
+        }
+        total += won[t].size();
+    }
+    // Only isolated single seats may be left once no pair fits
+    int economyLeft = 0;
+    for (Seat* seat : show->getAvailableSeats()) {
+        if (seat->getSeatCategory() == SeatCategory::Economy) economyLeft++;
+    }
+    if (total + economyLeft != 1000 || show->findBestAvailable(2, SeatCategory::Economy, picked)) {
+        cout << "FAIL: " << total << " Economy seats allocated, " << economyLeft << " left" << endl;
+        pass = false;
+    }
+    cout << threads << " threads booked " << total << " Economy seats, " << economyLeft << " single seats left" << endl;
+    cout << (pass ? "PASS" : "FAIL") << endl;
+}
+
+int main(int argc, char* argv[]) {
+    cout << "=== BookMyShow Demo ===" << endl;
+    
+    Movie movie("Inception", 148, "Leonardo DiCaprio", "Sci-Fi", 8.8);
+    MovieController movieController;
+    movieController.addMovie(movie, City::Delhi);
+    
+    Screen* imax = new Screen(2, SeatLayout(standardHall));
+    const SeatGeometry& lastSeat = imax->getLayout()[imax->getTotalSeats() - 1];
+    cout << "IMAX screen: " << imax->getTotalSeats() << " seats, last seat row " << lastSeat.row
+         << " number " << lastSeat.number << " at column " << lastSeat.column << endl;
+    
+    TheatreController theatreController;
+    Screen* screen = new Screen(1, 100);
+    Theatre* theatre = new Theatre(1, "PVR Select City", "Saket, Delhi", City::Delhi);
+    theatre->addScreen(screen);
+    theatreController.addTheatre(theatre, City::Delhi);
+    
+    Show* show = new Show(1, "18:00", "20:30", movie, screen, "2024-06-01");
+    Show* matinee = new Show(2, "12:00", "14:30", movie, screen, "2024-06-01");
+    screen->addShow(show);
+    screen->addShow(matinee);
+    theatreController.addShow(theatre, show);
+    theatreController.addShow(theatre, matinee);
+    
+    cout << "Shows of " << movieController.findMovie("Inception")->getMovieName() << " in Delhi on 2024-06-01:";
+    for (const auto& entry : theatreController.getShowsForMovie(City::Delhi, "Inception", "2024-06-01")) {
+        cout << " " << entry.show->getStartTime() << " @ " << entry.theatre->getTheatreName() << ";";
+    }
+    cout << endl;
+    
+    User* alice = new User(1, "Alice", "alice@example.com", "9999900001");
+    User* bob = new User(2, "Bob", "bob@example.com", "9999900002");
+    
+    Booking* first = new Booking(1, alice, show, {81, 82, 83, 84, 85, 86, 87, 88, 89, 90}, "2024-06-01");
+    first->confirmBooking("UPI");
+    first->printBookingDetails();
+    
+    // Overlapping request must fail while the first booking holds seat 85
+    Booking* second = new Booking(2, bob, show, {85, 91}, "2024-06-01");
+    if (!second->confirmBooking("Card")) {
+        cout << "\nBooking 2 failed: seat 85 already booked" << endl;
+    }
+    
+    first->cancelBooking();
+    cout << "Available seats after cancellation: " << show->getAvailableSeats().size() << endl;
+    
+    // Let the show pick the best pair of Gold seats
+    SeatIndexList bestSeats;
+    show->findBestAvailable(2, SeatCategory::Gold, bestSeats);
+    Booking* best = new Booking(3, bob, show, bestSeats, "2024-06-01");
+    best->confirmBooking("Card");
+    best->printBookingDetails();
+    
+    // Gold sells out; Charlie waits for two Gold seats and gets Bob's on cancel
+    User* charlie = new User(3, "Charlie", "charlie@example.com", "9999900003");
+    SeatIndexList goldBlock;
+    while (show->bookBestAvailable(1, SeatCategory::Gold, goldBlock)) {}
+    show->joinWaitlist(charlie->getUserID(), 2, SeatCategory::Gold, [&](const SeatIndexList& offered, long long holdID) {
+        cout << "\nWaitlist offer for " << charlie->getName() << ": " << offered.size() << " Gold seats" << endl;
+        Booking* fromWaitlist = new Booking(4, charlie, show, offered, "2024-06-01");
+        fromWaitlist->markSeatsHeld(holdID);
+        fromWaitlist->confirmBooking("UPI");
+    });
+    cout << "Waitlist size: " << show->getWaitlistSize() << endl;
+    best->cancelBooking();
+    
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkBestAvailable();
+        checkBestAvailableConsistency();
+        benchmarkShowCatalog();
+        simulateSurgePricing();
+        benchmarkPaymentPipeline();
+        benchmarkWaitlist();
+        benchmarkJournal();
+        benchmarkSeatMapFeed();
+        benchmarkScreenLayouts();
+        benchmarkGroupBooking();
+    }
+    
+    return 0;
+}
@@ -12,20 +12,24 @@ class Display{
     int floorNumber;
     Direction direction;
     public:
+    static bool silent; // set for benchmark runs
     Display(int id, int floor, Direction dir){
         this->displayId=id;
         this->floorNumber=floor;
         this->direction=dir;
     }
     void showFloor(){
+        if(silent) return;
         cout<<"Display "<<displayId<<" showing floor "<<floorNumber<<" direction "<<(direction==Direction::UP?"UP":"DOWN")<<endl;
     }
     void goToFloor(int floor, Direction dir){
         floorNumber=floor;
         direction=dir;
+        if(silent) return;
         cout<<"Display "<<displayId<<" going to floor "<<floor<<" direction "<<(dir==Direction::UP?"UP":"DOWN")<<endl;
     }
 };
+bool Display::silent=false;
 class InternalButton;
 class Elevater{
     private:
@@ -34,6 +38,7 @@ class Elevater{
     Direction direction;
     Display* display;
     InternalButton* internalButton;
+    long floorsTraveled=0;
     public:
     Elevater(int id, int floor, Direction dir, InternalButton* button){
         this->elevatorId=id;
@@ -45,7 +50,9 @@ class Elevater{
     int getElevatorId(){ return elevatorId; }
     int getCurrentFloor(){ return currentFloor; }
     Direction getDirection(){ return direction; }
+    long getFloorsTraveled(){ return floorsTraveled; }
     void goToFloor(int floor, Direction dir){
+        floorsTraveled+=abs(floor-currentFloor);
         display->showFloor();
         display->goToFloor(floor, dir);
         currentFloor=floor;
@@ -62,6 +69,16 @@ class Controller{
     Elevater* elevator;
     priority_queue<int, vector<int>, greater<int>> upQueue; // Min-heap for UP direction
     priority_queue<int> downQueue; // Max-heap for DOWN direction
+    int highestUp=INT_MIN; // extremes of the queued stops, for cost estimates
+    int lowestDown=INT_MAX;
+    vector<int> pendingDropOffs; // destinations of assigned passengers not yet picked up
+    // Floors the LOOK sweep covers: up to the highest up-stop, then down to the lowest down-stop
+    int sweepLength(int from, int high, int low){
+        int length=0;
+        if(high!=INT_MIN){ length+=high-from; from=high; }
+        if(low!=INT_MAX) length+=from-low;
+        return length;
+    }
     public:
     Controller(int id, Display* disp, Elevater* elev){
         this->contollerId=id;
@@ -72,10 +89,44 @@ class Controller{
         // algorrith to add it to the min hep or max heap based on the direction and floor number
         if(floor>elevator->getCurrentFloor()){
             upQueue.push(floor);
+            highestUp=max(highestUp, floor);
         }else{
             downQueue.push(floor);      
+            lowestDown=min(lowestDown, floor);
+        }
+    }
+    // Floors to travel for the queued sweep plus the extra pickups, then a
+    // second sweep from where that ends for the drop-offs
+    int plannedTravel(const vector<int>& pickups, const vector<int>& dropOffs){
+        int current=elevator->getCurrentFloor();
+        int high=highestUp, low=lowestDown;
+        for(int f: pickups){
+            if(f>current) high=max(high, f);
+            else low=min(low, f);
         }
+        int travel=sweepLength(current, high, low);
+        int end=low!=INT_MAX? low: high!=INT_MIN? high: current;
+        int high2=INT_MIN, low2=INT_MAX;
+        vector<int> drops=pendingDropOffs;
+        drops.insert(drops.end(), dropOffs.begin(), dropOffs.end());
+        for(int f: drops){
+            if(f>end) high2=max(high2, f);
+            else low2=min(low2, f);
+        }
+        return travel+sweepLength(end, high2, low2);
+    }
+    // Extra floors this car would travel if it also picked up at these floors
+    // (and, when known, dropped off at these); stops it already makes, or
+    // passes on the way, cost nothing
+    int estimateCost(const vector<int>& pickups, const vector<int>& dropOffs={}){
+        return plannedTravel(pickups, dropOffs)-plannedTravel({}, {});
+    }
+    // Destination dispatch: the car will take this passenger on to `floor` without an inside press
+    void expectDropOff(int floor){
+        pendingDropOffs.push_back(floor);
     }
+    int getControllerId(){ return contollerId; }
+    Elevater* getElevator(){ return elevator; }
     void processRequests(){
         // LOOK: sweep up serving all up-requests, then sweep down
         while(!upQueue.empty()){
@@ -86,6 +137,15 @@ class Controller{
             int f=downQueue.top(); downQueue.pop();
             elevator->goToFloor(f, Direction::DOWN);
         }
+        highestUp=INT_MIN;
+        lowestDown=INT_MAX;
+        // Everyone picked up on that sweep is aboard now: take them where they keyed in
+        if(!pendingDropOffs.empty()){
+            vector<int> dropOffs;
+            dropOffs.swap(pendingDropOffs);
+            for(int f: dropOffs) requestElevator(f);
+            processRequests();
+        }
     }
 };
 
@@ -105,20 +165,105 @@ class InternalButton{
     }
 };
 
+// Decides which controllers answer a hall call. destination is -1 unless the
+// caller keyed in where they are going (destination dispatch panels).
+// dir is passed along but no strategy here weighs it: Controller queues a
+// stop by where it lies from the car, not by the caller's direction, so a
+// down call above a rising car costs the same as an up call there
+class AssignmentStrategy{
+    public:
+    virtual ~AssignmentStrategy(){}
+    virtual vector<Controller*> choose(vector<Controller*>& controllers, int floor, Direction dir, int destination)=0;
+    virtual string getName()=0;
+};
+
+// Original behaviour: every car answers every call
+class BroadcastStrategy: public AssignmentStrategy{
+    public:
+    vector<Controller*> choose(vector<Controller*>& controllers, int /*floor*/, Direction /*dir*/, int /*destination*/) override{
+        return controllers;
+    }
+    string getName() override{ return "broadcast"; }
+};
+
+// The car whose sweep grows the least by adding this floor
+class NearestCarStrategy: public AssignmentStrategy{
+    public:
+    vector<Controller*> choose(vector<Controller*>& controllers, int floor, Direction /*dir*/, int /*destination*/) override{
+        Controller* best=controllers[0];
+        int bestCost=INT_MAX;
+        for(Controller* ctrl: controllers){
+            int cost=ctrl->estimateCost({floor});
+            if(cost<bestCost){ bestCost=cost; best=ctrl; }
+        }
+        return {best};
+    }
+    string getName() override{ return "nearest car"; }
+};
+
+// Each car owns a contiguous band of floors, whichever way the caller is
+// going; the lobby, shared by all bands, goes to the nearest car
+class ZoneStrategy: public AssignmentStrategy{
+    private:
+    int totalFloors;
+    NearestCarStrategy lobbyStrategy;
+    public:
+    ZoneStrategy(int floors){
+        this->totalFloors=floors;
+    }
+    vector<Controller*> choose(vector<Controller*>& controllers, int floor, Direction dir, int destination) override{
+        if(floor==0) return lobbyStrategy.choose(controllers, floor, dir, destination);
+        int zone=(floor-1)*(int)controllers.size()/max(1, totalFloors-1);
+        return {controllers[min(zone, (int)controllers.size()-1)]};
+    }
+    string getName() override{ return "zone"; }
+};
+
+// Destination dispatch: the passenger's destination is known at the hall,
+// so the cost covers both the pickup and the drop-off. A car already
+// stopping at that destination adds nothing for it, which groups passengers
+// going to the same floor into the same car.
+class DestinationDispatchStrategy: public AssignmentStrategy{
+    private:
+    NearestCarStrategy fallback;
+    public:
+    vector<Controller*> choose(vector<Controller*>& controllers, int floor, Direction dir, int destination) override{
+        if(destination<0) return fallback.choose(controllers, floor, dir, destination);
+        Controller* best=controllers[0];
+        int bestCost=INT_MAX;
+        for(Controller* ctrl: controllers){
+            int cost=ctrl->estimateCost({floor}, {destination});
+            if(cost<bestCost){ bestCost=cost; best=ctrl; }
+        }
+        return {best};
+    }
+    string getName() override{ return "destination dispatch"; }
+};
+
 class Dispatcher{
     private:
     int dispatcherId;
     vector<Controller*> controllers;
+    AssignmentStrategy* strategy;
     public:
-    Dispatcher(int id, vector<Controller*> ctrls){
+    Dispatcher(int id, vector<Controller*> ctrls, AssignmentStrategy* strat=nullptr){
         this->dispatcherId=id;
         this->controllers=ctrls;
+        this->strategy=strat? strat: new NearestCarStrategy();
     }
-    void assignElevator(int floor, Direction dir){
-        // logic to assign the best elevator based on the current state of elevators
-        for(Controller* ctrl: controllers){
+    ~Dispatcher(){ delete strategy; }
+    void setStrategy(AssignmentStrategy* strat){
+        delete strategy;
+        strategy=strat;
+    }
+    // Returns the car sent, so a destination panel can tell the caller which one to take
+    Controller* assignElevator(int floor, Direction dir, int destination=-1){
+        vector<Controller*> chosen=strategy->choose(controllers, floor, dir, destination);
+        for(Controller* ctrl: chosen){
             ctrl->requestElevator(floor);
+            if(destination>=0) ctrl->expectDropOff(destination);
         }
+        return chosen[0];
     }
 };
 
@@ -141,7 +286,58 @@ class ExternalButton{
         dispatcher->assignElevator(floorNumber, direction);
     }
 };
-int main(){
+// Total car-floors traveled by a 4-car bank in a 30-floor building serving
+// the same 4000 passengers under each strategy. Passengers arrive in groups
+// of four: their hall calls are assigned and the cars collect them; then each
+// passenger presses their floor in the car they boarded (with destination
+// dispatch the car already knows it).
+void benchmarkStrategies(){
+    const int floors=30, cars=4, rounds=1000, perRound=4;
+    Display::silent=true;
+    vector<AssignmentStrategy*> strategies={new BroadcastStrategy(), new NearestCarStrategy(),
+                                            new ZoneStrategy(floors), new DestinationDispatchStrategy()};
+    cout<<"\n=== Assignment strategy benchmark ("<<floors<<" floors, "<<cars<<" cars, "<<rounds*perRound<<" passengers) ==="<<endl;
+    for(AssignmentStrategy* strategy: strategies){
+        vector<Elevater*> elevators;
+        vector<Controller*> controllers;
+        for(int i=0;i<cars;i++){
+            elevators.push_back(new Elevater(i+1, 0, Direction::UP, nullptr));
+            controllers.push_back(new Controller(i+1, nullptr, elevators.back()));
+        }
+        bool keysDestination=dynamic_cast<DestinationDispatchStrategy*>(strategy)!=nullptr;
+        string name=strategy->getName();
+        Dispatcher dispatcher(1, controllers, strategy);
+        mt19937 rng(5);
+        for(int r=0;r<rounds;r++){
+            vector<pair<Controller*, int>> boarding;
+            for(int p=0;p<perRound;p++){
+                int kind=rng()%4, origin, destination;
+                if(kind<2){ origin=0; destination=1+rng()%(floors-1); }
+                else if(kind==2){ origin=1+rng()%(floors-1); destination=0; }
+                else{
+                    origin=1+rng()%(floors-1);
+                    do destination=1+rng()%(floors-1); while(destination==origin);
+                }
+                Direction dir=destination>origin? Direction::UP: Direction::DOWN;
+                Controller* car=dispatcher.assignElevator(origin, dir, keysDestination? destination: -1);
+                boarding.push_back({car, destination});
+            }
+            for(Controller* ctrl: controllers) ctrl->processRequests();
+            if(!keysDestination){
+                for(auto& rider: boarding) rider.first->requestElevator(rider.second);
+                for(Controller* ctrl: controllers) ctrl->processRequests();
+            }
+        }
+        long traveled=0;
+        for(Elevater* elevator: elevators) traveled+=elevator->getFloorsTraveled();
+        cout<<name<<": "<<traveled<<" car-floors traveled"<<endl;
+        for(Controller* ctrl: controllers) delete ctrl;
+        for(Elevater* elevator: elevators) delete elevator;
+    }
+    Display::silent=false;
+}
+
+int main(int argc, char* argv[]){
     Elevater* elevator=new Elevater(1, 0, Direction::UP, nullptr);
     Display* display=new Display(1, 0, Direction::UP);
     Controller* controller=new Controller(1, display, elevator);
@@ -155,5 +351,9 @@ int main(){
     // Round 2: rider inside presses floor 2 -> car sweeps down
     (new InternalButton(1, 2, controller))->pressButton();
     controller->processRequests();          // serves 2
+
+    if(argc>1 && string(argv[1])=="--bench"){
+        benchmarkStrategies();
+    }
     return 0;
 }
@@ -11,6 +11,104 @@ enum class Status {
     Idle  // Fixed typo: "Idol" -> "Idle"
 };
 
+// A button press on its way to a control thread
+struct PanelRequest {
+    int floor;
+    Direction direction;
+    bool fromCar;  // destination pressed inside a car; otherwise a hall call
+    chrono::steady_clock::time_point pressedAt;
+};
+
+// Bounded lock-free queue from any number of pressing threads to one control
+// thread. Every slot carries a sequence number that tells a producer whether
+// the slot is free for the position it claimed, and the consumer whether the
+// request in it has been published. An idle consumer blocks in waitForRequest;
+// producers only touch the mutex when it is actually waiting.
+class RequestQueue {
+private:
+    struct Slot {
+        atomic<uint64_t> sequence;
+        PanelRequest request;
+    };
+    
+    unique_ptr<Slot[]> slots;
+    uint64_t mask;
+    alignas(64) atomic<uint64_t> enqueuePos{0};
+    alignas(64) uint64_t dequeuePos = 0;  // consumer only
+    atomic<bool> consumerWaiting{false};
+    mutex wakeMutex;
+    condition_variable wakeUp;
+    
+    // The publishing store, this load and the consumer's two sides are all
+    // seq_cst, so either the consumer sees the request or the producer sees
+    // the consumer waiting
+    bool hasRequest() const {
+        return slots[dequeuePos & mask].sequence.load() == dequeuePos + 1;
+    }
+    
+    void notifyConsumer() {
+        if (consumerWaiting.load()) wake();
+    }
+    
+public:
+    explicit RequestQueue(size_t capacity = 1024) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) slots[i].sequence.store(i, memory_order_relaxed);
+    }
+    
+    bool tryPush(const PanelRequest& request) {
+        uint64_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            int64_t lag = (int64_t)(slot.sequence.load(memory_order_acquire) - pos);
+            if (lag == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    slot.request = request;
+                    slot.sequence.store(pos + 1);
+                    notifyConsumer();
+                    return true;
+                }
+            } else if (lag < 0) {
+                return false;  // full: the consumer has not freed this slot yet
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    // A press is never dropped: wait for room instead
+    void push(const PanelRequest& request) {
+        while (!tryPush(request)) this_thread::yield();
+    }
+    
+    bool tryPop(PanelRequest& request) {
+        Slot& slot = slots[dequeuePos & mask];
+        if (slot.sequence.load(memory_order_acquire) != dequeuePos + 1) return false;
+        request = slot.request;
+        slot.sequence.store(dequeuePos + mask + 1, memory_order_release);
+        dequeuePos++;
+        return true;
+    }
+    
+    // Consumer: blocks until a request is published or giveUp() is true.
+    // Whoever makes giveUp() true must call wake() afterwards.
+    template <typename GiveUp>
+    void waitForRequest(GiveUp giveUp) {
+        unique_lock<mutex> lock(wakeMutex);
+        consumerWaiting.store(true);
+        wakeUp.wait(lock, [&]() { return hasRequest() || giveUp(); });
+        consumerWaiting.store(false, memory_order_relaxed);
+    }
+    
+    void wake() {
+        lock_guard<mutex> lock(wakeMutex);
+        wakeUp.notify_one();
+    }
+};
+
 // Forward declarations
 class ElevatorController;
 
@@ -110,6 +208,7 @@ public:
 class InternButtonPanel {
 private:
     InternalDispatcher* dispatcher;
+    RequestQueue* intake = nullptr;
     
 public:
     InternButtonPanel(ElevatorController* controller) {
@@ -120,7 +219,16 @@ public:
         delete dispatcher;
     }
     
+    // Under a control thread, presses go to its queue instead
+    void connect(RequestQueue* carIntake) {
+        intake = carIntake;
+    }
+    
     void pressButton(int destination) {
+        if (intake != nullptr) {
+            intake->push({destination, Direction::Upwards, true, chrono::steady_clock::now()});
+            return;
+        }
         dispatcher->addDestination(destination);
     }
     
@@ -133,6 +241,7 @@ class ExternalButtonPanel {
 private:
     ExternalDispatcher* dispatcher;
     int floorNumber;
+    RequestQueue* hallCalls = nullptr;
     
 public:
     ExternalButtonPanel(int floor, ElevatorController* controller) : floorNumber(floor) {
@@ -143,12 +252,25 @@ public:
         delete dispatcher;
     }
     
+    // Under a dispatcher thread, presses go to its queue instead
+    void connect(RequestQueue* dispatcherQueue) {
+        hallCalls = dispatcherQueue;
+    }
+    
     void pressUpButton() {
-        dispatcher->addRequest(floorNumber, Direction::Upwards);
+        press(Direction::Upwards);
     }
     
     void pressDownButton() {
-        dispatcher->addRequest(floorNumber, Direction::Downwards);
+        press(Direction::Downwards);
+    }
+    
+    void press(Direction direction) {
+        if (hallCalls != nullptr) {
+            hallCalls->push({floorNumber, direction, false, chrono::steady_clock::now()});
+            return;
+        }
+        dispatcher->addRequest(floorNumber, direction);
     }
     
     ExternalDispatcher* getDispatcher() {
@@ -181,71 +303,208 @@ public:
 // Forward declaration for ElevatorCar
 class ElevatorCar;
 
+// One bit per floor. Finding the next floor in the set above or below a
+// given floor is a count-trailing/leading-zeros on one word for buildings
+// of up to 64 floors, and a short word scan beyond that.
+class FloorSet {
+private:
+    vector<uint64_t> words;
+    
+public:
+    void insert(int floor) {
+        size_t word = floor / 64;
+        if (word >= words.size()) words.resize(word + 1, 0);
+        words[word] |= 1ull << (floor % 64);
+    }
+    
+    void erase(int floor) {
+        size_t word = floor / 64;
+        if (word < words.size()) words[word] &= ~(1ull << (floor % 64));
+    }
+    
+    bool contains(int floor) const {
+        size_t word = floor / 64;
+        return word < words.size() && (words[word] >> (floor % 64)) & 1;
+    }
+    
+    bool empty() const {
+        for (uint64_t word : words) {
+            if (word) return false;
+        }
+        return true;
+    }
+    
+    // Lowest floor in the set that is >= floor, or -1
+    int nextAtOrAbove(int floor) const {
+        if (floor < 0) floor = 0;
+        size_t word = floor / 64;
+        if (word >= words.size()) return -1;
+        uint64_t bits = words[word] & (~0ull << (floor % 64));
+        while (true) {
+            if (bits) return (int)(word * 64 + __builtin_ctzll(bits));
+            if (++word == words.size()) return -1;
+            bits = words[word];
+        }
+    }
+    
+    // Highest floor in the set that is <= floor, or -1
+    int nextAtOrBelow(int floor) const {
+        if (floor < 0 || words.empty()) return -1;
+        size_t word = floor / 64;
+        uint64_t bits;
+        if (word >= words.size()) {
+            word = words.size() - 1;
+            bits = words[word];
+        } else {
+            bits = words[word] & (~0ull >> (63 - floor % 64));
+        }
+        while (true) {
+            if (bits) return (int)(word * 64 + 63 - __builtin_clzll(bits));
+            if (word-- == 0) return -1;
+            bits = words[word];
+        }
+    }
+    
+    int lowest() const {
+        return nextAtOrAbove(0);
+    }
+    
+    uint64_t getWord(size_t index) const {
+        return index < words.size() ? words[index] : 0;
+    }
+    
+    int highest() const {
+        return nextAtOrBelow(INT_MAX);
+    }
+};
+
 class ElevatorController {
 private:
-    // LOOK algorithm implementation
-    priority_queue<int, vector<int>, greater<int>> upRequests;   // Min heap for upward
-    priority_queue<int> downRequests;  // Max heap for downward
+    // LOOK algorithm: floors to stop at while going up and while going down.
+    // A floor is in a set at most once, so repeated presses cost nothing.
+    FloorSet upStops;
+    FloorSet downStops;
     ElevatorCar* elevator;
     Direction currentDirection;
+    int currentFloor = 0;  // last floor reported by the car
+    
+    static Direction opposite(Direction direction) {
+        return direction == Direction::Upwards ? Direction::Downwards : Direction::Upwards;
+    }
+    
+    FloorSet& stopsFor(Direction direction) {
+        return direction == Direction::Upwards ? upStops : downStops;
+    }
+    
+    // Next stop of a sweep starting at `floor` in `direction`: the nearest
+    // stop for that direction ahead, else the furthest stop for the other
+    // direction ahead (where the car turns)
+    int nextInSweep(int floor, Direction direction) {
+        bool up = direction == Direction::Upwards;
+        int next = up ? upStops.nextAtOrAbove(floor) : downStops.nextAtOrBelow(floor);
+        if (next != -1) return next;
+        int turn = up ? downStops.highest() : upStops.lowest();
+        if (turn != -1 && (up ? turn > floor : turn < floor)) return turn;
+        return -1;
+    }
+    
+    // Next stop and the direction the car leaves it in. At most two sweeps are
+    // examined, so this always terminates: if the current direction has
+    // nothing ahead, any remaining stop is reachable by a sweep the other way.
+    int findNext(int floor, Direction& leaving) {
+        Direction direction = currentDirection;
+        for (int attempt = 0; attempt < 2; attempt++) {
+            int next = nextInSweep(floor, direction);
+            if (next != -1) {
+                // A turnaround stop is left the other way
+                leaving = stopsFor(direction).contains(next) ? direction : opposite(direction);
+                return next;
+            }
+            direction = opposite(direction);
+        }
+        return -1;
+    }
     
 public:
     ElevatorController(ElevatorCar* elev) : elevator(elev), currentDirection(Direction::Upwards) {}
     
     void addInternalRequest(int floor) {
         cout << "Controller: Adding internal request for floor " << floor << endl;
-        if (currentDirection == Direction::Upwards) {
-            upRequests.push(floor);
-        } else {
-            downRequests.push(floor);
-        }
+        queueCarCall(floor);
     }
     
     void addExternalRequest(int floor, Direction direction) {
         cout << "Controller: Adding external request for floor " << floor << endl;
-        if (direction == Direction::Upwards) {
-            upRequests.push(floor);
+        queueHallCall(floor, direction);
+    }
+    
+    // A destination chosen inside the car: it is served on the way up if it is
+    // above the car and on the way down if below, whatever the car is doing now
+    void queueCarCall(int floor) {
+        if (floor > currentFloor) {
+            upStops.insert(floor);
+        } else if (floor < currentFloor) {
+            downStops.insert(floor);
         } else {
-            downRequests.push(floor);
+            stopsFor(currentDirection).insert(floor);  // already here: next stop
         }
     }
     
+    // A hall call is served by a sweep in the caller's direction
+    void queueHallCall(int floor, Direction direction) {
+        stopsFor(direction).insert(floor);
+    }
+    
+    void updateFloor(int floor) {
+        currentFloor = floor;
+    }
+    
+    // Removes and returns the next floor to visit, or -1 if there is none
     int getNextDestination(int currentFloor) {
-        if (currentDirection == Direction::Upwards && !upRequests.empty()) {
-            int nextFloor = upRequests.top();
-            if (nextFloor >= currentFloor) {
-                upRequests.pop();
-                return nextFloor;
-            }
+        this->currentFloor = currentFloor;
+        Direction leaving;
+        int next = findNext(currentFloor, leaving);
+        if (next != -1) {
+            currentDirection = leaving;
+            stopsFor(leaving).erase(next);
         }
-        
-        if (currentDirection == Direction::Downwards && !downRequests.empty()) {
-            int nextFloor = downRequests.top();
-            if (nextFloor <= currentFloor) {
-                downRequests.pop();
-                return nextFloor;
-            }
-        }
-        
-        // Switch direction if needed
-        if (currentDirection == Direction::Upwards && upRequests.empty() && !downRequests.empty()) {
-            currentDirection = Direction::Downwards;
-            return getNextDestination(currentFloor);
-        } else if (currentDirection == Direction::Downwards && downRequests.empty() && !upRequests.empty()) {
-            currentDirection = Direction::Upwards;
-            return getNextDestination(currentFloor);
+        return next;
+    }
+    
+    // Chooses the next floor to visit without removing it and points the
+    // controller at it; -1 if there is none. A car that re-plans at every
+    // floor with this picks up calls made while it moves, and commits with
+    // getNextDestination once it is at the returned floor.
+    int planNextDestination(int currentFloor) {
+        this->currentFloor = currentFloor;
+        Direction leaving;
+        int next = findNext(currentFloor, leaving);
+        if (next != -1 && next != currentFloor) {
+            currentDirection = next > currentFloor ? Direction::Upwards : Direction::Downwards;
         }
-        
-        return -1; // No requests
+        return next;
     }
     
     bool hasRequests() {
-        return !upRequests.empty() || !downRequests.empty();
+        return !upStops.empty() || !downStops.empty();
     }
     
     Direction getCurrentDirection() {
         return currentDirection;
     }
+    
+    // Bits 64*index .. 64*index+63 of the floors queued in either direction
+    uint64_t getStopWord(size_t index) {
+        return upStops.getWord(index) | downStops.getWord(index);
+    }
+    
+    // Every floor queued in either direction
+    vector<int> getPendingStops() {
+        vector<int> stops;
+        for (int f = upStops.lowest(); f != -1; f = upStops.nextAtOrAbove(f + 1)) stops.push_back(f);
+        for (int f = downStops.lowest(); f != -1; f = downStops.nextAtOrAbove(f + 1)) stops.push_back(f);
+        return stops;
+    }
 };
 
 class ElevatorCar {
@@ -258,6 +517,8 @@ private:
     int currentFloor;
     ElevatorDoor* door;
     ElevatorController* controller;
+    int load = 0;       // passengers on board
+    int capacity = 16;
     
 public:
     ElevatorCar(int id, Direction direction = Direction::Upwards, Status status = Status::Idle) 
@@ -292,6 +553,7 @@ public:
         
         while (currentFloor != destination) {
             currentFloor = currentFloor + (direction == Direction::Downwards ? -1 : 1);
+            controller->updateFloor(currentFloor);
             showDisplay();
             // Simulate movement time
             // this_thread::sleep_for(chrono::milliseconds(500));
@@ -318,28 +580,150 @@ public:
         return currentFloor;
     }
     
+    Direction getDirection() {
+        return direction;
+    }
+    
+    Status getStatus() {
+        return status;
+    }
+    
+    int getLoad() {
+        return load;
+    }
+    
+    int getCapacity() {
+        return capacity;
+    }
+    
     ElevatorController* getController() {
         return controller;
     }
 };
 
+// What a group dispatcher needs to know about one car when a hall call comes in
+struct CarSnapshot {
+    int floor;
+    Direction direction;
+    Status status;
+    vector<int> stops;  // floors the car is already committed to
+    int load;
+    int capacity;
+};
+
+// Group Dispatcher: picks which car of the bank answers a hall call
+class GroupDispatcher {
+public:
+    virtual ~GroupDispatcher() = default;
+    virtual int selectCar(const vector<CarSnapshot>& cars, int floor, Direction direction) = 0;
+    virtual string getName() = 0;
+};
+
+// The original policy: every hall call goes to the first car
+class FirstCarDispatcher : public GroupDispatcher {
+public:
+    int selectCar(const vector<CarSnapshot>& /*cars*/, int /*floor*/, Direction /*direction*/) override {
+        return 0;
+    }
+    
+    string getName() override {
+        return "first car";
+    }
+};
+
+// Estimated-time-to-arrival dispatcher: the car that would reach the caller
+// soonest wins, counting the floors it still has to cover in its current
+// sweep, the stops it makes before the caller's floor, and how full it is
+class EtaDispatcher : public GroupDispatcher {
+private:
+    double floorSeconds;  // travel time per floor
+    double stopSeconds;   // door cycle plus boarding at one stop
+    double fullPenaltySeconds = 600;
+    
+public:
+    EtaDispatcher(double floorSeconds = 1.5, double stopSeconds = 8.0)
+        : floorSeconds(floorSeconds), stopSeconds(stopSeconds) {}
+    
+    double estimateArrival(const CarSnapshot& car, int floor, Direction direction) {
+        double eta;
+        if (car.status == Status::Idle && car.stops.empty()) {
+            eta = abs(floor - car.floor) * floorSeconds;
+        } else {
+            bool up = car.direction == Direction::Upwards;
+            auto ahead = [&](int f) { return up ? f > car.floor : f < car.floor; };
+            bool onTheWay = direction == car.direction && (floor == car.floor || ahead(floor));
+            
+            int stopsBefore = 0;
+            double distance;
+            if (onTheWay) {
+                for (int stop : car.stops) {
+                    if (ahead(stop) && (up ? stop < floor : stop > floor)) stopsBefore++;
+                }
+                distance = abs(floor - car.floor);
+            } else {
+                // Finish the current sweep, then come back for the caller
+                int turn = car.floor;
+                for (int stop : car.stops) {
+                    if (ahead(stop)) {
+                        turn = up ? max(turn, stop) : min(turn, stop);
+                        stopsBefore++;
+                    }
+                }
+                for (int stop : car.stops) {
+                    if (!ahead(stop) && stop != car.floor && (up ? stop > floor : stop < floor)) stopsBefore++;
+                }
+                distance = abs(turn - car.floor) + abs(turn - floor);
+            }
+            eta = distance * floorSeconds + stopsBefore * stopSeconds;
+        }
+        
+        if (car.load >= car.capacity) {
+            eta += fullPenaltySeconds;
+        } else {
+            eta += stopSeconds * car.load / car.capacity;  // fuller cars stop more and board slower
+        }
+        return eta;
+    }
+    
+    int selectCar(const vector<CarSnapshot>& cars, int floor, Direction direction) override {
+        int best = 0;
+        double bestEta = numeric_limits<double>::max();
+        for (int i = 0; i < (int)cars.size(); i++) {
+            double eta = estimateArrival(cars[i], floor, direction);
+            if (eta < bestEta) {
+                bestEta = eta;
+                best = i;
+            }
+        }
+        return best;
+    }
+    
+    string getName() override {
+        return "ETA";
+    }
+};
+
 // Building class to manage everything
 class Building {
 private:
     vector<ElevatorCar*> elevators;
     vector<ExternalButtonPanel*> floorPanels;
     int totalFloors;
+    GroupDispatcher* groupDispatcher;
     
 public:
     Building(int floors, int numElevators) : totalFloors(floors) {
+        this->groupDispatcher = new EtaDispatcher();
+        
         // Create elevators
         for (int i = 0; i < numElevators; i++) {
             elevators.push_back(new ElevatorCar(i + 1));
         }
         
-        // Create floor panels (external buttons)
+        // Create floor panels (external buttons); hall calls are routed to a car
+        // by the group dispatcher, so no panel belongs to one controller
         for (int i = 0; i < floors; i++) {
-            floorPanels.push_back(new ExternalButtonPanel(i, elevators[0]->getController()));
+            floorPanels.push_back(new ExternalButtonPanel(i, nullptr));
         }
     }
     
@@ -350,6 +734,13 @@ public:
         for (auto panel : floorPanels) {
             delete panel;
         }
+        delete groupDispatcher;
+    }
+    
+    // Takes ownership of `dispatcher`
+    void setGroupDispatcher(GroupDispatcher* dispatcher) {
+        delete groupDispatcher;
+        groupDispatcher = dispatcher;
     }
     
     void callElevator(int floor, Direction direction) {
@@ -360,8 +751,14 @@ public:
             floorPanels[floor]->pressDownButton();
         }
         
-        // Find best elevator (simplified - just use first one)
-        elevators[0]->getController()->addExternalRequest(floor, direction);
+        vector<CarSnapshot> cars;
+        for (auto elevator : elevators) {
+            cars.push_back({elevator->getCurrentFloor(), elevator->getDirection(), elevator->getStatus(),
+                            elevator->getController()->getPendingStops(), elevator->getLoad(),
+                            elevator->getCapacity()});
+        }
+        int chosen = groupDispatcher->selectCar(cars, floor, direction);
+        elevators[chosen]->getController()->addExternalRequest(floor, direction);
     }
     
     void simulateElevatorMovement() {
@@ -371,7 +768,1000 @@ public:
     }
 };
 
-int main() {
+/**
+ * CONCURRENT CONTROL
+ *
+ * Panels push presses into lock-free RequestQueues and return at once. Each
+ * car has its own control thread that takes its queue into its controller
+ * and re-plans at every floor, so calls made while the car moves are picked
+ * up on the way. One dispatcher thread takes the hall calls, reads the cars'
+ * published state and hands each call to the chosen car's queue. Apart from
+ * those queues, threads only share atomics.
+ */
+class CarControlLoop {
+private:
+    int id;
+    ElevatorController controller;
+    RequestQueue intake;
+    InternButtonPanel panel;
+    chrono::microseconds floorTime;
+    chrono::microseconds doorTime;
+    int capacity;
+    atomic<bool> running{false};
+    thread worker;
+    
+    // Published by the control thread for the dispatcher
+    atomic<int> floor{0};
+    atomic<int> direction{1};
+    atomic<bool> idle{true};
+    atomic<int> load{0};  // riders aboard: one per car call not yet served
+    vector<atomic<uint64_t>> publishedStops;
+    
+    // Owned by the control thread; read after stop()
+    vector<int> ridersFor;  // riders aboard per destination floor
+    vector<double> intakeMicros;
+    long stopsMade = 0;
+    long requestsTaken = 0;
+    
+    void takeRequests() {
+        PanelRequest request;
+        bool any = false;
+        while (intake.tryPop(request)) {
+            if (request.fromCar) {
+                controller.queueCarCall(request.floor);
+                ridersFor[request.floor]++;
+                load.fetch_add(1, memory_order_relaxed);
+            } else {
+                controller.queueHallCall(request.floor, request.direction);
+            }
+            intakeMicros.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - request.pressedAt).count());
+            requestsTaken++;
+            any = true;
+        }
+        if (any) publishStops();
+    }
+    
+    void publishStops() {
+        for (size_t i = 0; i < publishedStops.size(); i++) {
+            publishedStops[i].store(controller.getStopWord(i), memory_order_relaxed);
+        }
+    }
+    
+    void run() {
+        int current = 0;
+        while (true) {
+            takeRequests();
+            int next = controller.planNextDestination(current);
+            if (next == -1) {
+                idle.store(true, memory_order_release);
+                if (!running.load(memory_order_acquire)) {
+                    takeRequests();  // anything pushed before stop() was called
+                    if (!controller.hasRequests()) break;
+                    continue;
+                }
+                intake.waitForRequest([this]() { return !running.load(memory_order_acquire); });
+                continue;
+            }
+            idle.store(false, memory_order_relaxed);
+            
+            if (next == current) {
+                controller.getNextDestination(current);
+                direction.store(controller.getCurrentDirection() == Direction::Upwards ? 1 : -1, memory_order_relaxed);
+                load.fetch_sub(ridersFor[current], memory_order_relaxed);
+                ridersFor[current] = 0;
+                publishStops();
+                stopsMade++;
+                this_thread::sleep_for(doorTime);
+                continue;
+            }
+            direction.store(next > current ? 1 : -1, memory_order_relaxed);
+            this_thread::sleep_for(floorTime);
+            current += next > current ? 1 : -1;
+            controller.updateFloor(current);
+            floor.store(current, memory_order_relaxed);
+        }
+    }
+    
+public:
+    CarControlLoop(int id, int floors, chrono::microseconds floorTime, chrono::microseconds doorTime, int capacity = 16)
+        : id(id), controller(nullptr), panel(nullptr), floorTime(floorTime), doorTime(doorTime), capacity(capacity),
+          publishedStops((floors + 63) / 64), ridersFor(floors, 0) {
+        panel.connect(&intake);
+    }
+    
+    ~CarControlLoop() {
+        stop();
+    }
+    
+    void start() {
+        running.store(true, memory_order_release);
+        worker = thread(&CarControlLoop::run, this);
+    }
+    
+    // Serves everything already queued, then ends the control thread
+    void stop() {
+        running.store(false, memory_order_release);
+        intake.wake();
+        if (worker.joinable()) worker.join();
+    }
+    
+    // Hands over a hall call chosen for this car
+    void assign(const PanelRequest& request) {
+        intake.push(request);
+    }
+    
+    // Read by the dispatcher thread while the car runs
+    CarSnapshot snapshot() {
+        CarSnapshot snap{floor.load(memory_order_relaxed),
+                         direction.load(memory_order_relaxed) > 0 ? Direction::Upwards : Direction::Downwards,
+                         idle.load(memory_order_acquire) ? Status::Idle : Status::Moving, {},
+                         load.load(memory_order_relaxed), capacity};
+        for (size_t i = 0; i < publishedStops.size(); i++) {
+            uint64_t word = publishedStops[i].load(memory_order_relaxed);
+            for (; word; word &= word - 1) snap.stops.push_back((int)(i * 64 + __builtin_ctzll(word)));
+        }
+        return snap;
+    }
+    
+    InternButtonPanel* getPanel() {
+        return &panel;
+    }
+    
+    int getId() {
+        return id;
+    }
+    
+    long getStopsMade() {
+        return stopsMade;
+    }
+    
+    long getRequestsTaken() {
+        return requestsTaken;
+    }
+    
+    const vector<double>& getIntakeMicros() {
+        return intakeMicros;
+    }
+};
+
+class GroupControlSystem {
+private:
+    vector<unique_ptr<CarControlLoop>> cars;
+    vector<unique_ptr<ExternalButtonPanel>> floorPanels;
+    RequestQueue hallCalls;
+    GroupDispatcher* dispatcher;
+    atomic<bool> running{false};
+    thread dispatchThread;
+    vector<double> assignMicros;  // dispatcher thread only
+    
+    void dispatchLoop() {
+        PanelRequest request;
+        vector<CarSnapshot> snapshots;
+        while (true) {
+            if (!hallCalls.tryPop(request)) {
+                if (!running.load(memory_order_acquire)) {
+                    if (!hallCalls.tryPop(request)) break;
+                } else {
+                    hallCalls.waitForRequest([this]() { return !running.load(memory_order_acquire); });
+                    continue;
+                }
+            }
+            snapshots.clear();
+            for (auto& car : cars) snapshots.push_back(car->snapshot());
+            int chosen = dispatcher->selectCar(snapshots, request.floor, request.direction);
+            cars[chosen]->assign(request);
+            assignMicros.push_back(chrono::duration<double, micro>(chrono::steady_clock::now() - request.pressedAt).count());
+        }
+    }
+    
+public:
+    // Takes ownership of `dispatcher`
+    GroupControlSystem(int floors, int numCars, GroupDispatcher* dispatcher,
+                       chrono::microseconds floorTime, chrono::microseconds doorTime)
+        : hallCalls(4096), dispatcher(dispatcher) {
+        for (int i = 0; i < numCars; i++) {
+            cars.push_back(make_unique<CarControlLoop>(i + 1, floors, floorTime, doorTime));
+        }
+        for (int f = 0; f < floors; f++) {
+            floorPanels.push_back(make_unique<ExternalButtonPanel>(f, nullptr));
+            floorPanels.back()->connect(&hallCalls);
+        }
+    }
+    
+    ~GroupControlSystem() {
+        stop();
+        delete dispatcher;
+    }
+    
+    void start() {
+        for (auto& car : cars) car->start();
+        running.store(true, memory_order_release);
+        dispatchThread = thread(&GroupControlSystem::dispatchLoop, this);
+    }
+    
+    // Assigns every hall call already pressed, lets the cars serve every
+    // stop, then ends all threads
+    void stop() {
+        running.store(false, memory_order_release);
+        hallCalls.wake();
+        if (dispatchThread.joinable()) dispatchThread.join();
+        for (auto& car : cars) car->stop();
+    }
+    
+    ExternalButtonPanel* getFloorPanel(int floor) {
+        return floorPanels[floor].get();
+    }
+    
+    InternButtonPanel* getCarPanel(int car) {
+        return cars[car]->getPanel();
+    }
+    
+    CarControlLoop* getCar(int car) {
+        return cars[car].get();
+    }
+    
+    int getCarCount() {
+        return (int)cars.size();
+    }
+    
+    // Press to assignment latencies of hall calls; valid after stop()
+    const vector<double>& getAssignMicros() {
+        return assignMicros;
+    }
+};
+
+/**
+ * DISCRETE-EVENT SIMULATION
+ *
+ * Runs a bank of cars under a GroupDispatcher against generated passenger
+ * traffic. Nothing is stepped: the engine pops the next event (a passenger
+ * arriving, a car reaching its stop, doors finishing their cycle) from a
+ * time-ordered queue and jumps the clock straight to it, so hours of traffic
+ * take milliseconds. Cars run collective control: they stop for car calls
+ * and for hall calls assigned to them in their direction of travel, and turn
+ * at the last call ahead.
+ */
+
+// Motion profile of a car: accelerate, cruise at top speed, brake
+struct TravelModel {
+    double floorHeight = 3.5;   // metres
+    double topSpeed = 2.5;      // metres per second
+    double acceleration = 1.0;  // metres per second squared (braking too)
+    
+    // Seconds from standing at one floor to standing `floors` floors away
+    double tripTime(int floors) const {
+        double distance = floors * floorHeight;
+        double rampDistance = topSpeed * topSpeed / acceleration;  // speeding up plus slowing down
+        if (distance <= rampDistance) return 2 * sqrt(distance / acceleration);
+        return distance / topSpeed + topSpeed / acceleration;
+    }
+    
+    // Seconds into such a trip at which the car must start braking
+    double brakeStartTime(int floors) const {
+        double distance = floors * floorHeight;
+        return tripTime(floors) - min(topSpeed / acceleration, sqrt(distance / acceleration));
+    }
+};
+
+// Door cycle at a stop: open, let people through, close
+struct DoorModel {
+    double openTime = 2.0;
+    double closeTime = 2.5;
+    double perPassenger = 1.2;  // boarding or alighting, one at a time
+    double minimumDwell = 3.0;  // doors stay open at least this long
+    
+    double dwellTime(int alighted, int boarded) const {
+        return openTime + max(minimumDwell, perPassenger * (alighted + boarded)) + closeTime;
+    }
+};
+
+struct SimPassenger {
+    int origin;
+    int destination;
+    double arrivalTime;
+    double boardTime = 0;
+};
+
+// One stretch of a traffic day with Poisson arrivals at a constant rate.
+// fromLobby and toLobby are the shares of trips starting or ending at floor
+// 0; the rest travel between upper floors.
+struct TrafficPhase {
+    double duration;
+    double arrivalsPerSecond;
+    double fromLobby;
+    double toLobby;
+};
+
+// Generates passengers for a sequence of traffic phases
+class ArrivalGenerator {
+private:
+    vector<TrafficPhase> phases;
+    int floors;
+    mt19937 rng;
+    size_t phase = 0;
+    double phaseStart = 0;
+    double clock = 0;
+    
+    int randomFloor(int low, int high) {
+        return uniform_int_distribution<int>(low, high)(rng);
+    }
+    
+public:
+    ArrivalGenerator(vector<TrafficPhase> phases, int floors, unsigned seed)
+        : phases(phases), floors(floors), rng(seed) {}
+    
+    // Next passenger in time order; false once the last phase has ended
+    bool next(SimPassenger& passenger) {
+        while (phase < phases.size()) {
+            const TrafficPhase& current = phases[phase];
+            double phaseEnd = phaseStart + current.duration;
+            if (current.arrivalsPerSecond > 0) {
+                clock += exponential_distribution<double>(current.arrivalsPerSecond)(rng);
+            }
+            if (current.arrivalsPerSecond <= 0 || clock >= phaseEnd) {
+                // Poisson arrivals are memoryless: restart the draw at the phase boundary
+                clock = phaseStart = phaseEnd;
+                phase++;
+                continue;
+            }
+            double kind = uniform_real_distribution<double>(0, 1)(rng);
+            if (kind < current.fromLobby) {
+                passenger = {0, randomFloor(1, floors - 1), clock};
+            } else if (kind < current.fromLobby + current.toLobby) {
+                passenger = {randomFloor(1, floors - 1), 0, clock};
+            } else {
+                int origin = randomFloor(1, floors - 1);
+                int destination = randomFloor(1, floors - 2);
+                if (destination >= origin) destination++;
+                passenger = {origin, destination, clock};
+            }
+            return true;
+        }
+        return false;
+    }
+    
+    // Standard office-building profiles
+    static vector<TrafficPhase> upPeak(double hours, double arrivalsPerSecond) {
+        return {{hours * 3600, arrivalsPerSecond, 0.85, 0.05}};
+    }
+    
+    static vector<TrafficPhase> downPeak(double hours, double arrivalsPerSecond) {
+        return {{hours * 3600, arrivalsPerSecond, 0.05, 0.85}};
+    }
+    
+    static vector<TrafficPhase> lunch(double hours, double arrivalsPerSecond) {
+        return {{hours * 3600, arrivalsPerSecond, 0.4, 0.4}};
+    }
+    
+    static vector<TrafficPhase> officeDay(double arrivalsPerSecond) {
+        return {{1.5 * 3600, arrivalsPerSecond, 0.85, 0.05},
+                {2.5 * 3600, arrivalsPerSecond * 0.3, 0.1, 0.1},
+                {1.5 * 3600, arrivalsPerSecond * 0.8, 0.4, 0.4},
+                {3.0 * 3600, arrivalsPerSecond * 0.3, 0.1, 0.1},
+                {1.5 * 3600, arrivalsPerSecond, 0.05, 0.85}};
+    }
+};
+
+// Wait, ride and throughput figures of one simulation run
+struct SimulationMetrics {
+    vector<double> waits;     // arrival until boarding
+    vector<double> rides;     // boarding until alighting
+    vector<double> journeys;  // arrival until alighting
+    long carFloorsTraveled = 0;
+    long stops = 0;
+    double simulatedSeconds = 0;
+    size_t unserved = 0;
+    
+    static double mean(const vector<double>& values) {
+        return values.empty() ? 0 : accumulate(values.begin(), values.end(), 0.0) / values.size();
+    }
+    
+    static double percentile(vector<double> values, double fraction) {
+        if (values.empty()) return 0;
+        size_t index = (size_t)(fraction * (values.size() - 1));
+        nth_element(values.begin(), values.begin() + index, values.end());
+        return values[index];
+    }
+    
+    double throughputPerHour() const {
+        return simulatedSeconds > 0 ? journeys.size() * 3600.0 / simulatedSeconds : 0;
+    }
+    
+    static void writeCsvHeader(ostream& out) {
+        out << "scenario,dispatcher,floors,cars,delivered,unserved,avg_wait_s,p95_wait_s,max_wait_s,"
+               "avg_ride_s,p95_ride_s,avg_journey_s,throughput_per_hour,car_floors,stops,simulated_s" << endl;
+    }
+    
+    void writeCsvRow(ostream& out, const string& scenario, const string& dispatcher, int floors, int cars) const {
+        out << scenario << "," << dispatcher << "," << floors << "," << cars << "," << journeys.size() << ","
+            << unserved << "," << mean(waits) << "," << percentile(waits, 0.95) << ","
+            << percentile(waits, 1.0) << "," << mean(rides) << "," << percentile(rides, 0.95) << ","
+            << mean(journeys) << "," << throughputPerHour() << "," << carFloorsTraveled << "," << stops << ","
+            << simulatedSeconds << endl;
+    }
+};
+
+class ElevatorSimulation {
+private:
+    enum class EventType {
+        PassengerArrival,
+        CarArrival,   // car comes to rest at its target floor
+        DoorsClosed,  // dwell over, car may leave
+        HallRecall    // someone left behind by a full car calls again
+    };
+    
+    struct SimEvent {
+        double time;
+        long sequence;  // ties are handled in scheduling order
+        EventType type;
+        int car;
+        long version;   // a car event is stale once the car's version moves on
+        int floor;
+        int direction;
+        
+        bool operator>(const SimEvent& other) const {
+            return time != other.time ? time > other.time : sequence > other.sequence;
+        }
+    };
+    
+    enum class CarState {
+        Idle,
+        Moving,
+        DoorsOpen
+    };
+    
+    struct SimCar {
+        CarState state = CarState::Idle;
+        int floor = 0;       // where it stands, or where the current run started
+        int direction = 0;   // +1 up, -1 down, 0 none
+        int target = 0;      // end of the current run
+        double runStart = 0;
+        long version = 0;
+        vector<char> carCall, hallUp, hallDown;
+        vector<SimPassenger> riders;
+    };
+    
+    int floors;
+    int capacity;
+    GroupDispatcher* dispatcher;
+    TravelModel travel;
+    DoorModel doors;
+    vector<SimCar> cars;
+    vector<deque<SimPassenger>> waitingUp, waitingDown;
+    priority_queue<SimEvent, vector<SimEvent>, greater<SimEvent>> events;
+    long nextSequence = 0;
+    double now = 0;
+    SimulationMetrics metrics;
+    
+    void schedule(double time, EventType type, int car = -1, int floor = 0, int direction = 0) {
+        long version = car >= 0 ? cars[car].version : 0;
+        events.push({time, nextSequence++, type, car, version, floor, direction});
+    }
+    
+    bool wantsStop(const SimCar& car, int floor, int direction) const {
+        return car.carCall[floor] || (direction > 0 ? car.hallUp : car.hallDown)[floor];
+    }
+    
+    bool hasCall(const SimCar& car, int floor) const {
+        return car.carCall[floor] || car.hallUp[floor] || car.hallDown[floor];
+    }
+    
+    // First floor ahead of `from` worth stopping at when heading `direction`:
+    // the nearest call in that direction, else the furthest call of any kind
+    // (where the car turns). -1 if there is nothing ahead.
+    int nextStopAhead(const SimCar& car, int from, int direction) const {
+        int furthest = -1;
+        for (int f = from; f >= 0 && f < floors; f += direction) {
+            if (wantsStop(car, f, direction)) return f;
+            if (hasCall(car, f)) furthest = f;
+        }
+        return furthest;
+    }
+    
+    // Nearest floor the moving car can still stop at
+    int committedFloor(const SimCar& car) const {
+        int span = abs(car.target - car.floor);
+        for (int k = 1; k < span; k++) {
+            if (now <= car.runStart + travel.brakeStartTime(k)) return car.floor + k * car.direction;
+        }
+        return car.target;
+    }
+    
+    void startRun(int index, int target) {
+        SimCar& car = cars[index];
+        car.state = CarState::Moving;
+        car.direction = target > car.floor ? 1 : -1;
+        car.target = target;
+        car.runStart = now;
+        car.version++;
+        schedule(now + travel.tripTime(abs(target - car.floor)), EventType::CarArrival, index);
+    }
+    
+    // Called whenever a car gains a call: wake it, or shorten or extend its run
+    void reconsider(int index) {
+        SimCar& car = cars[index];
+        if (car.state == CarState::Idle) {
+            if (hasCall(car, car.floor)) {
+                openDoors(index);
+                return;
+            }
+            int target = nextStopAhead(car, car.floor, 1);
+            if (target < 0) target = nextStopAhead(car, car.floor, -1);
+            if (target >= 0) startRun(index, target);
+            return;
+        }
+        if (car.state != CarState::Moving) return;  // picked up when the doors close
+        
+        // Same acceleration profile up to the brake point, so a run can be
+        // retargeted as long as the car has started braking neither for the
+        // new stop nor, when extending, for the stop it is heading to now
+        int desired = nextStopAhead(car, committedFloor(car), car.direction);
+        if (desired < 0 || desired == car.target) return;
+        int span = abs(desired - car.floor);
+        if (now > car.runStart + travel.brakeStartTime(span)) return;
+        if (now > car.runStart + travel.brakeStartTime(abs(car.target - car.floor))) return;
+        car.target = desired;
+        car.version++;
+        schedule(car.runStart + travel.tripTime(span), EventType::CarArrival, index);
+    }
+    
+    vector<CarSnapshot> snapshots() const {
+        vector<CarSnapshot> result;
+        for (const SimCar& car : cars) {
+            CarSnapshot snap{car.state == CarState::Moving ? committedFloor(car) : car.floor,
+                             car.direction < 0 ? Direction::Downwards : Direction::Upwards,
+                             car.state == CarState::Idle ? Status::Idle : Status::Moving,
+                             {}, (int)car.riders.size(), capacity};
+            for (int f = 0; f < floors; f++) {
+                if (hasCall(car, f)) snap.stops.push_back(f);
+            }
+            result.push_back(snap);
+        }
+        return result;
+    }
+    
+    void assignHallCall(int floor, int direction) {
+        for (const SimCar& car : cars) {
+            if ((direction > 0 ? car.hallUp : car.hallDown)[floor]) return;  // already answered
+        }
+        int chosen = dispatcher->selectCar(snapshots(), floor,
+                                           direction > 0 ? Direction::Upwards : Direction::Downwards);
+        (direction > 0 ? cars[chosen].hallUp : cars[chosen].hallDown)[floor] = 1;
+        reconsider(chosen);
+    }
+    
+    void openDoors(int index) {
+        SimCar& car = cars[index];
+        int f = car.floor;
+        car.state = CarState::DoorsOpen;
+        car.version++;
+        car.carCall[f] = 0;
+        metrics.stops++;
+        
+        int alighted = 0;
+        for (size_t i = 0; i < car.riders.size();) {
+            if (car.riders[i].destination == f) {
+                const SimPassenger& p = car.riders[i];
+                metrics.rides.push_back(now - p.boardTime);
+                metrics.journeys.push_back(now - p.arrivalTime);
+                car.riders[i] = car.riders.back();
+                car.riders.pop_back();
+                alighted++;
+            } else {
+                i++;
+            }
+        }
+        
+        // Keep the direction while there is work ahead, otherwise serve whoever called here
+        int serving = car.direction;
+        if (serving == 0 || nextStopAhead(car, f + serving, serving) < 0) {
+            if (car.hallUp[f] && !car.hallDown[f]) serving = 1;
+            else if (car.hallDown[f] && !car.hallUp[f]) serving = -1;
+            else if (serving == 0) serving = car.hallUp[f] || nextStopAhead(car, f + 1, 1) >= 0 ? 1 : -1;
+        }
+        car.direction = serving;
+        
+        int boarded = 0;
+        auto& queueHere = serving > 0 ? waitingUp[f] : waitingDown[f];
+        (serving > 0 ? car.hallUp : car.hallDown)[f] = 0;
+        while (!queueHere.empty() && (int)car.riders.size() < capacity) {
+            SimPassenger p = queueHere.front();
+            queueHere.pop_front();
+            p.boardTime = now;
+            metrics.waits.push_back(now - p.arrivalTime);
+            car.carCall[p.destination] = 1;
+            car.riders.push_back(p);
+            boarded++;
+        }
+        double dwell = doors.dwellTime(alighted, boarded);
+        schedule(now + dwell, EventType::DoorsClosed, index);
+        if (!queueHere.empty()) {
+            schedule(now + dwell, EventType::HallRecall, -1, f, serving);
+        }
+    }
+    
+    void closeDoors(int index) {
+        SimCar& car = cars[index];
+        car.state = CarState::Idle;
+        // A full car leaves calls made here meanwhile for its next visit
+        bool roomLeft = (int)car.riders.size() < capacity;
+        if (roomLeft && wantsStop(car, car.floor, car.direction)) {
+            openDoors(index);  // someone called here while the doors were open
+            return;
+        }
+        int target = nextStopAhead(car, car.floor + car.direction, car.direction);
+        if (target < 0 && roomLeft && hasCall(car, car.floor)) {
+            car.direction = -car.direction;  // nothing ahead: take the callers going the other way
+            openDoors(index);
+            return;
+        }
+        if (target < 0) target = nextStopAhead(car, car.floor - car.direction, -car.direction);
+        if (target < 0) {
+            car.direction = 0;
+            car.version++;
+            return;
+        }
+        startRun(index, target);
+    }
+    
+    void arrive(int index) {
+        SimCar& car = cars[index];
+        metrics.carFloorsTraveled += abs(car.target - car.floor);
+        car.floor = car.target;
+        if (car.direction != 0 && !wantsStop(car, car.floor, car.direction) &&
+            nextStopAhead(car, car.floor, car.direction) < 0) {
+            car.direction = -car.direction;  // turnaround for a call the other way
+        }
+        openDoors(index);
+    }
+    
+public:
+    ElevatorSimulation(int floors, int numCars, int capacity, GroupDispatcher* dispatcher,
+                       TravelModel travel = TravelModel(), DoorModel doors = DoorModel())
+        : floors(floors), capacity(capacity), dispatcher(dispatcher), travel(travel), doors(doors),
+          cars(numCars), waitingUp(floors), waitingDown(floors) {
+        for (auto& car : cars) {
+            car.carCall.assign(floors, 0);
+            car.hallUp.assign(floors, 0);
+            car.hallDown.assign(floors, 0);
+        }
+    }
+    
+    // Runs until the traffic ends and everyone has arrived (or drainLimit
+    // seconds past the last arrival, for a hopelessly overloaded bank)
+    SimulationMetrics run(ArrivalGenerator& generator, double drainLimit = 4 * 3600) {
+        SimPassenger pending;
+        bool more = generator.next(pending);
+        if (more) schedule(pending.arrivalTime, EventType::PassengerArrival);
+        double lastArrival = 0;
+        
+        while (!events.empty()) {
+            SimEvent event = events.top();
+            events.pop();
+            if (!more && event.time > lastArrival + drainLimit) break;
+            now = event.time;
+            if (event.car >= 0 && event.version != cars[event.car].version) continue;  // superseded
+            
+            switch (event.type) {
+                case EventType::PassengerArrival: {
+                    int direction = pending.destination > pending.origin ? 1 : -1;
+                    (direction > 0 ? waitingUp : waitingDown)[pending.origin].push_back(pending);
+                    assignHallCall(pending.origin, direction);
+                    lastArrival = now;
+                    more = generator.next(pending);
+                    if (more) schedule(pending.arrivalTime, EventType::PassengerArrival);
+                    break;
+                }
+                case EventType::CarArrival:
+                    arrive(event.car);
+                    break;
+                case EventType::DoorsClosed:
+                    closeDoors(event.car);
+                    break;
+                case EventType::HallRecall:
+                    if (!(event.direction > 0 ? waitingUp : waitingDown)[event.floor].empty()) {
+                        assignHallCall(event.floor, event.direction);
+                    }
+                    break;
+            }
+        }
+        
+        metrics.simulatedSeconds = now;
+        for (int f = 0; f < floors; f++) metrics.unserved += waitingUp[f].size() + waitingDown[f].size();
+        for (const SimCar& car : cars) metrics.unserved += car.riders.size();
+        return metrics;
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Benchmarks (run with --bench)
+// ---------------------------------------------------------------------------
+
+// 50 floors, 8 cars of 16, one hour of morning up-peak at 0.25 arrivals/s
+void benchmarkGroupDispatch() {
+    cout << "\n=== Group dispatch benchmark (50 floors, 8 cars, up-peak) ===" << endl;
+    FirstCarDispatcher firstCar;
+    EtaDispatcher eta;
+    for (GroupDispatcher* dispatcher : vector<GroupDispatcher*>{&firstCar, &eta}) {
+        ElevatorSimulation simulation(50, 8, 16, dispatcher);
+        ArrivalGenerator traffic(ArrivalGenerator::upPeak(1, 0.25), 50, 42);
+        SimulationMetrics metrics = simulation.run(traffic);
+        cout << dispatcher->getName() << ": avg wait " << SimulationMetrics::mean(metrics.waits)
+             << " s, p95 wait " << SimulationMetrics::percentile(metrics.waits, 0.95) << " s, "
+             << metrics.journeys.size() << " delivered, " << metrics.unserved << " not delivered" << endl;
+    }
+}
+
+// Drives a controller the way processRequests does, without the printing:
+// returns the floors visited in order, stopping after maxStops
+vector<int> runController(ElevatorController& controller, int startFloor, int maxStops) {
+    vector<int> visits;
+    int floor = startFloor;
+    while (controller.hasRequests() && (int)visits.size() < maxStops) {
+        int next = controller.getNextDestination(floor);
+        if (next == -1) break;
+        floor = next;
+        controller.updateFloor(floor);
+        visits.push_back(floor);
+    }
+    return visits;
+}
+
+int countReversals(const vector<int>& visits, int startFloor) {
+    int reversals = 0, lastDirection = 0, floor = startFloor;
+    for (int next : visits) {
+        int direction = next > floor ? 1 : next < floor ? -1 : 0;
+        if (direction != 0 && lastDirection != 0 && direction != lastDirection) reversals++;
+        if (direction != 0) lastDirection = direction;
+        floor = next;
+    }
+    return reversals;
+}
+
+// Request patterns that broke the heap-based scheduler: each must finish,
+// serve every call exactly once and sweep instead of zig-zagging
+void checkSchedulerPatterns() {
+    cout << "\n=== LOOK scheduler checks ===" << endl;
+    auto report = [](const char* name, bool ok) {
+        cout << (ok ? "PASS " : "FAIL ") << name << endl;
+    };
+    
+    {
+        ElevatorController controller(nullptr);
+        for (int i = 0; i < 1000; i++) {
+            controller.queueCarCall(7);
+            controller.queueHallCall(7, Direction::Upwards);
+        }
+        vector<int> visits = runController(controller, 0, 100);
+        report("1000 duplicate presses stop once", visits == vector<int>{7});
+    }
+    {
+        // Car going up at 10 gets a call for 3: the old code queued it as an
+        // upward stop it could never reach and spun forever
+        ElevatorController controller(nullptr);
+        controller.queueCarCall(10);
+        vector<int> visits = runController(controller, 0, 10);
+        controller.queueCarCall(3);
+        controller.queueCarCall(12);
+        vector<int> rest = runController(controller, 10, 10);
+        report("call behind a rising car is served after the sweep", visits == vector<int>{10} &&
+               rest == vector<int>{12, 3});
+    }
+    {
+        ElevatorController controller(nullptr);
+        controller.queueHallCall(0, Direction::Upwards);
+        controller.queueHallCall(49, Direction::Downwards);
+        for (int f = 1; f < 49; f++) {
+            controller.queueHallCall(f, Direction::Upwards);
+            controller.queueHallCall(f, Direction::Downwards);
+        }
+        vector<int> visits = runController(controller, 25, 1000);
+        set<int> distinct(visits.begin(), visits.end());
+        report("every floor both ways: 98 stops in at most 2 reversals",
+               visits.size() == 98 && distinct.size() == 50 && countReversals(visits, 25) <= 2);
+    }
+    {
+        // New calls at alternating extremes after every stop
+        ElevatorController controller(nullptr);
+        int floor = 25;
+        bool ok = true;
+        for (int i = 0; i < 200; i++) {
+            controller.queueCarCall(i % 2 ? 49 : 0);
+            int next = controller.getNextDestination(floor);
+            ok = ok && next != -1;
+            floor = next;
+            controller.updateFloor(floor);
+        }
+        vector<int> rest = runController(controller, floor, 10);
+        report("alternating extremes never stall", ok && rest.size() <= 2 && !controller.hasRequests());
+    }
+    {
+        ElevatorController controller(nullptr);
+        controller.updateFloor(5);
+        controller.queueCarCall(5);
+        controller.queueHallCall(5, Direction::Downwards);
+        vector<int> visits = runController(controller, 5, 10);
+        report("calls at the current floor open the doors there", visits == vector<int>{5, 5});
+    }
+    {
+        // Random calls in a 200-floor building (several bitset words), with
+        // arrivals while the car moves; every call must be served exactly once
+        mt19937 rng(11);
+        ElevatorController controller(nullptr);
+        set<pair<int, int>> outstanding;  // (floor, +1 up / -1 down / 0 car call)
+        int floor = 0;
+        long served = 0;
+        bool ok = true;
+        for (int step = 0; step < 20000 && ok; step++) {
+            for (int k = 0; k < 3; k++) {
+                int f = rng() % 200, kind = (int)(rng() % 3) - 1;
+                if (kind == 0) {
+                    if (f == floor) continue;
+                    controller.queueCarCall(f);
+                    outstanding.insert({f, f > floor ? 1 : -1});
+                } else {
+                    controller.queueHallCall(f, kind > 0 ? Direction::Upwards : Direction::Downwards);
+                    outstanding.insert({f, kind});
+                }
+            }
+            int next = controller.getNextDestination(floor);
+            if (next == -1) break;
+            // The stop satisfies the call for the direction the car leaves in
+            int leaving = controller.getCurrentDirection() == Direction::Upwards ? 1 : -1;
+            ok = outstanding.erase({next, leaving}) == 1 || outstanding.erase({next, -leaving}) == 1;
+            floor = next;
+            controller.updateFloor(floor);
+            served++;
+        }
+        vector<int> rest = runController(controller, floor, 1000);
+        report("200 floors, random arrivals: no phantom or lost stops",
+               ok && rest.size() == outstanding.size() && !controller.hasRequests());
+    }
+}
+
+// Requests queued plus destinations popped per second, for a 50-floor car
+// (one bitset word) and a 500-floor one
+void benchmarkSchedulerThroughput() {
+    cout << "\n=== LOOK scheduler throughput ===" << endl;
+    for (int floors : {50, 500}) {
+        ElevatorController controller(nullptr);
+        vector<int> calls(1 << 16);
+        mt19937 rng(3);
+        for (int& call : calls) call = rng() % floors;
+        const long operations = 20000000;
+        long checksum = 0;
+        int floor = 0;
+        auto start = chrono::steady_clock::now();
+        for (long i = 0; i < operations; i += 4) {
+            int f = calls[i & (calls.size() - 1)];
+            controller.queueCarCall(f);
+            controller.queueHallCall(calls[(i + 1) & (calls.size() - 1)], (i & 4) ? Direction::Upwards : Direction::Downwards);
+            controller.queueHallCall(calls[(i + 2) & (calls.size() - 1)], Direction::Upwards);
+            int next = controller.getNextDestination(floor);
+            if (next != -1) floor = next;
+            checksum += floor;
+        }
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << floors << " floors: " << (long)(operations / seconds) << " requests/sec (checksum " << checksum
+             << ")" << endl;
+    }
+}
+
+// One stress run: 16 threads press 500 buttons each, `pace` apart
+void runConcurrentPresses(const char* label, chrono::microseconds pace) {
+    const int floors = 50, pressers = 16, pressesEach = 500;
+    GroupControlSystem system(floors, 8, new EtaDispatcher(), chrono::microseconds(20), chrono::microseconds(50));
+    system.start();
+    
+    atomic<long> hallPresses{0}, carPresses{0};
+    auto start = chrono::steady_clock::now();
+    vector<thread> threads;
+    for (int t = 0; t < pressers; t++) {
+        threads.emplace_back([&, t]() {
+            mt19937 rng(t + 1);
+            for (int i = 0; i < pressesEach; i++) {
+                int f = rng() % floors;
+                if (rng() % 2) {
+                    system.getCarPanel(rng() % system.getCarCount())->pressButton(f);
+                    carPresses.fetch_add(1, memory_order_relaxed);
+                } else {
+                    ExternalButtonPanel* panel = system.getFloorPanel(f);
+                    if (f == floors - 1 || (f > 0 && rng() % 2)) {
+                        panel->pressDownButton();
+                    } else {
+                        panel->pressUpButton();
+                    }
+                    hallPresses.fetch_add(1, memory_order_relaxed);
+                }
+                if (pace.count() > 0) this_thread::sleep_for(pace);
+            }
+        });
+    }
+    for (auto& presser : threads) presser.join();
+    double pressSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    system.stop();
+    double totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    
+    long taken = 0, stops = 0;
+    vector<double> intake;
+    for (int i = 0; i < system.getCarCount(); i++) {
+        CarControlLoop* car = system.getCar(i);
+        taken += car->getRequestsTaken();
+        stops += car->getStopsMade();
+        intake.insert(intake.end(), car->getIntakeMicros().begin(), car->getIntakeMicros().end());
+    }
+    vector<double> assign = system.getAssignMicros();
+    auto percentile = [](vector<double>& values, double fraction) {
+        if (values.empty()) return 0.0;
+        sort(values.begin(), values.end());
+        return values[(size_t)(fraction * (values.size() - 1))];
+    };
+    
+    long pressed = hallPresses.load() + carPresses.load();
+    cout << label << ": " << pressed << " presses from " << pressers << " threads in " << pressSeconds * 1000 << " ms; all served after "
+         << totalSeconds * 1000 << " ms with " << stops << " stops" << endl;
+    cout << (taken == pressed && (long)assign.size() == hallPresses.load() ? "PASS" : "FAIL")
+         << " every press reached a controller (" << taken << "/" << pressed << ")" << endl;
+    cout << "press -> assignment (hall calls): p50 " << percentile(assign, 0.5) << " us, p99 "
+         << percentile(assign, 0.99) << " us, max " << percentile(assign, 1.0) << " us" << endl;
+    cout << "press -> controller (all presses): p50 " << percentile(intake, 0.5) << " us, p99 "
+         << percentile(intake, 0.99) << " us, max " << percentile(intake, 1.0) << " us" << endl;
+}
+
+// Thousands of presses from many threads while the cars move, all at once
+// and then paced: every press must reach a controller and every stop must be
+// served. Latency is from the press to the hall call being assigned to a car,
+// and from the press to the car's controller taking it.
+void stressConcurrentControl() {
+    cout << "\n=== Concurrent control stress test (50 floors, 8 cars) ===" << endl;
+    runConcurrentPresses("burst", chrono::microseconds(0));
+    runConcurrentPresses("paced, a press per 500 us per thread", chrono::microseconds(500));
+}
+
+// Every dispatcher against every traffic scenario, one CSV row per run
+// (also written to `csvPath` when given)
+void benchmarkTrafficScenarios(const string& csvPath) {
+    cout << "\n=== Traffic scenarios (CSV) ===" << endl;
+    struct Scenario {
+        string name;
+        int floors;
+        int cars;
+        vector<TrafficPhase> phases;
+    };
+    vector<Scenario> scenarios = {
+        {"up-peak", 50, 8, ArrivalGenerator::upPeak(2, 0.25)},
+        {"down-peak", 50, 8, ArrivalGenerator::downPeak(2, 0.25)},
+        {"lunch", 50, 8, ArrivalGenerator::lunch(2, 0.2)},
+        {"office-day", 50, 8, ArrivalGenerator::officeDay(0.25)},
+        {"office-day-small", 20, 4, ArrivalGenerator::officeDay(0.1)},
+    };
+    
+    ofstream file;
+    if (!csvPath.empty()) file.open(csvPath);
+    SimulationMetrics::writeCsvHeader(cout);
+    if (file.is_open()) SimulationMetrics::writeCsvHeader(file);
+    
+    FirstCarDispatcher firstCar;
+    EtaDispatcher eta;
+    double simulated = 0;
+    auto start = chrono::steady_clock::now();
+    for (const Scenario& scenario : scenarios) {
+        for (GroupDispatcher* dispatcher : vector<GroupDispatcher*>{&firstCar, &eta}) {
+            ElevatorSimulation simulation(scenario.floors, scenario.cars, 16, dispatcher);
+            ArrivalGenerator traffic(scenario.phases, scenario.floors, 7);
+            SimulationMetrics metrics = simulation.run(traffic);
+            simulated += metrics.simulatedSeconds;
+            metrics.writeCsvRow(cout, scenario.name, dispatcher->getName(), scenario.floors, scenario.cars);
+            if (file.is_open()) {
+                metrics.writeCsvRow(file, scenario.name, dispatcher->getName(), scenario.floors, scenario.cars);
+            }
+        }
+    }
+    double elapsed = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << simulated / 3600 << " simulated hours in " << elapsed << " s" << endl;
+}
+
+int main(int argc, char* argv[]) {
     // Create a 10-floor building with 1 elevator
     Building building(10, 1);
     
@@ -385,5 +1775,14 @@ int main() {
     // Process all requests
     building.simulateElevatorMovement();
     
+    // --bench [results.csv]
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkGroupDispatch();
+        benchmarkTrafficScenarios(argc > 2 ? argv[2] : "");
+        checkSchedulerPatterns();
+        benchmarkSchedulerThroughput();
+        stressConcurrentControl();
+    }
+    
     return 0;
 }
\ No newline at end of file
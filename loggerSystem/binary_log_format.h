@@ -0,0 +1,31 @@
+// Wire format of the binary log files written by BinaryLogBackend (main.cpp)
+// and read back by log_decoder.cpp. All integers are stored in host byte order.
+//
+//   file      := magic record*
+//   magic     := "BINLOG01" (8 bytes)
+//   record    := format | entry | drops
+//   format    := 'F' u32 formatId  u8 level  u16 length  char[length]
+//   entry     := 'E' u32 formatId  i64 wallClockMicros  u16 length  arg-bytes[length]
+//   drops     := 'D' i64 wallClockMicros  u64 droppedEntries
+//   arg       := 'i' i64 | 'u' u64 | 'd' f64 | 's' u16 length char[length]
+//
+// A format record always precedes the first entry that uses its ID. Levels use
+// the numeric values of LogLevel (INFO = 1 ... FATAL = 5).
+#pragma once
+
+#include <cstdint>
+
+const char BinaryLogMagic[8] = {'B', 'I', 'N', 'L', 'O', 'G', '0', '1'};
+
+enum BinaryRecordType : uint8_t {
+    BinaryRecordFormat = 'F',
+    BinaryRecordEntry = 'E',
+    BinaryRecordDrops = 'D'
+};
+
+enum BinaryArgType : uint8_t {
+    BinaryArgSigned = 'i',
+    BinaryArgUnsigned = 'u',
+    BinaryArgDouble = 'd',
+    BinaryArgString = 's'
+};
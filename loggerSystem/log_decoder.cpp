@@ -0,0 +1,225 @@
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstring>
+#include <ctime>
+#include "binary_log_format.h"
+
+using namespace std;
+
+/**
+ * BINARY LOG DECODER
+ *
+ * Renders a file written by BinaryLogBackend (see binary_log_format.h) as
+ * text lines or as one JSON object per line.
+ *
+ * Usage: log_decoder [--json] <file>
+ */
+
+const char* levelName(uint8_t level) {
+    static const char* names[] = {"UNKNOWN", "INFO", "DEBUG", "WARNING", "ERROR", "FATAL"};
+    return level < 6 ? names[level] : names[0];
+}
+
+// "2026-10-19 14:53:18.123456" in local time
+string formatTimestamp(int64_t micros) {
+    time_t seconds = (time_t)(micros / 1000000);
+    tm parts;
+    localtime_r(&seconds, &parts);
+    char buffer[40];
+    size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &parts);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%06lld", (long long)(micros % 1000000));
+    return buffer;
+}
+
+string jsonEscape(const string& text) {
+    string escaped;
+    for (char c : text) {
+        switch (c) {
+            case '"': escaped += "\\\""; break;
+            case '\\': escaped += "\\\\"; break;
+            case '\n': escaped += "\\n"; break;
+            case '\t': escaped += "\\t"; break;
+            default:
+                if ((unsigned char)c < 0x20) {
+                    char code[8];
+                    snprintf(code, sizeof(code), "\\u%04x", c);
+                    escaped += code;
+                } else {
+                    escaped += c;
+                }
+        }
+    }
+    return escaped;
+}
+
+// One decoded argument: its text rendering and its JSON rendering
+struct DecodedArg {
+    string text;
+    string json;
+};
+
+class BinaryLogReader {
+private:
+    string data;
+    size_t offset = 0;
+
+public:
+    explicit BinaryLogReader(string contents) : data(move(contents)) {}
+    
+    bool atEnd() const { return offset >= data.size(); }
+    
+    template <typename T>
+    bool read(T& value) {
+        if (offset + sizeof(T) > data.size()) return false;
+        memcpy(&value, data.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return true;
+    }
+    
+    bool readBytes(size_t count, string& out) {
+        if (offset + count > data.size()) return false;
+        out.assign(data, offset, count);
+        offset += count;
+        return true;
+    }
+};
+
+bool decodeArgs(const string& bytes, vector<DecodedArg>& args) {
+    BinaryLogReader reader(bytes);
+    while (!reader.atEnd()) {
+        uint8_t tag = 0;
+        reader.read(tag);
+        if (tag == BinaryArgSigned) {
+            int64_t value;
+            if (!reader.read(value)) return false;
+            args.push_back({to_string(value), to_string(value)});
+        } else if (tag == BinaryArgUnsigned) {
+            uint64_t value;
+            if (!reader.read(value)) return false;
+            args.push_back({to_string(value), to_string(value)});
+        } else if (tag == BinaryArgDouble) {
+            double value;
+            if (!reader.read(value)) return false;
+            ostringstream text;
+            text << value;
+            args.push_back({text.str(), text.str()});
+        } else if (tag == BinaryArgString) {
+            uint16_t length;
+            string value;
+            if (!reader.read(length) || !reader.readBytes(length, value)) return false;
+            args.push_back({value, "\"" + jsonEscape(value) + "\""});
+        } else {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Substitutes the arguments for the "{}" markers, in order
+string renderMessage(const string& format, const vector<DecodedArg>& args) {
+    string message;
+    size_t next = 0;
+    for (size_t i = 0; i < format.size(); i++) {
+        if (format[i] == '{' && i + 1 < format.size() && format[i + 1] == '}' && next < args.size()) {
+            message += args[next++].text;
+            i++;
+        } else {
+            message += format[i];
+        }
+    }
+    return message;
+}
+
+int main(int argc, char* argv[]) {
+    bool json = false;
+    string path;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--json") {
+            json = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        cerr << "Usage: " << argv[0] << " [--json] <binary log file>" << endl;
+        return 2;
+    }
+    
+    ifstream in(path, ios::binary);
+    if (!in.is_open()) {
+        cerr << "Error: Could not open file " << path << endl;
+        return 1;
+    }
+    stringstream contents;
+    contents << in.rdbuf();
+    BinaryLogReader reader(contents.str());
+    
+    string magic;
+    if (!reader.readBytes(sizeof(BinaryLogMagic), magic) ||
+        memcmp(magic.data(), BinaryLogMagic, sizeof(BinaryLogMagic)) != 0) {
+        cerr << "Error: " << path << " is not a binary log file" << endl;
+        return 1;
+    }
+    
+    unordered_map<uint32_t, pair<uint8_t, string>> formats;
+    while (!reader.atEnd()) {
+        uint8_t type = 0;
+        reader.read(type);
+        if (type == BinaryRecordFormat) {
+            uint32_t formatId;
+            uint8_t level;
+            uint16_t length;
+            string format;
+            if (!reader.read(formatId) || !reader.read(level) || !reader.read(length) ||
+                !reader.readBytes(length, format)) break;
+            formats[formatId] = {level, format};
+        } else if (type == BinaryRecordEntry) {
+            uint32_t formatId;
+            int64_t timestamp;
+            uint16_t length;
+            string argBytes;
+            if (!reader.read(formatId) || !reader.read(timestamp) || !reader.read(length) ||
+                !reader.readBytes(length, argBytes)) break;
+            auto format = formats.find(formatId);
+            vector<DecodedArg> args;
+            if (format == formats.end() || !decodeArgs(argBytes, args)) {
+                cerr << "Error: corrupt entry for format " << formatId << endl;
+                return 1;
+            }
+            string message = renderMessage(format->second.second, args);
+            if (json) {
+                cout << "{\"timestamp\":\"" << formatTimestamp(timestamp) << "\",\"level\":\""
+                     << levelName(format->second.first) << "\",\"format\":\"" << jsonEscape(format->second.second)
+                     << "\",\"args\":[";
+                for (size_t i = 0; i < args.size(); i++) {
+                    cout << (i ? "," : "") << args[i].json;
+                }
+                cout << "],\"message\":\"" << jsonEscape(message) << "\"}" << '\n';
+            } else {
+                cout << "[" << formatTimestamp(timestamp) << "] [" << levelName(format->second.first) << "] "
+                     << message << '\n';
+            }
+        } else if (type == BinaryRecordDrops) {
+            int64_t timestamp;
+            uint64_t count;
+            if (!reader.read(timestamp) || !reader.read(count)) break;
+            if (json) {
+                cout << "{\"timestamp\":\"" << formatTimestamp(timestamp) << "\",\"dropped\":" << count << "}" << '\n';
+            } else {
+                cout << "[" << formatTimestamp(timestamp) << "] [WARNING] " << count
+                     << " log entries dropped (ring full)" << '\n';
+            }
+        } else {
+            cerr << "Error: unknown record type " << (int)type << endl;
+            return 1;
+        }
+    }
+    if (!reader.atEnd()) {
+        cerr << "Warning: file ends with a truncated record" << endl;
+    }
+    return 0;
+}
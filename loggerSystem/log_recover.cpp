@@ -0,0 +1,106 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <deque>
+#include <cstring>
+#include <cstdlib>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "mapped_log_format.h"
+
+using namespace std;
+
+/**
+ * CRASH LOG RECOVERY
+ *
+ * Prints the records that survived in a file written by MappedRingSink (see
+ * mapped_log_format.h), oldest first. Torn or partly overwritten records are
+ * skipped and counted.
+ *
+ * Usage: log_recover [--tail N] <file>
+ */
+
+const char* levelName(uint8_t level) {
+    static const char* names[] = {"UNKNOWN", "INFO", "DEBUG", "WARNING", "ERROR", "FATAL"};
+    return level < 6 ? names[level] : names[0];
+}
+
+// "2026-10-19 14:53:18.123456" in local time
+string formatTimestamp(int64_t micros) {
+    time_t seconds = (time_t)(micros / 1000000);
+    tm parts;
+    localtime_r(&seconds, &parts);
+    char buffer[40];
+    size_t length = strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", &parts);
+    snprintf(buffer + length, sizeof(buffer) - length, ".%06lld", (long long)(micros % 1000000));
+    return buffer;
+}
+
+int main(int argc, char* argv[]) {
+    size_t tail = 0;
+    string path;
+    for (int i = 1; i < argc; i++) {
+        if (string(argv[i]) == "--tail" && i + 1 < argc) {
+            tail = strtoul(argv[++i], nullptr, 10);
+        } else {
+            path = argv[i];
+        }
+    }
+    if (path.empty()) {
+        cerr << "Usage: " << argv[0] << " [--tail N] <mapped log file>" << endl;
+        return 2;
+    }
+    
+    int fd = open(path.c_str(), O_RDONLY);
+    struct stat info;
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        cerr << "Error: Could not open file " << path << endl;
+        return 1;
+    }
+    if ((size_t)info.st_size < MappedLogDataOffset) {
+        cerr << "Error: " << path << " is not a mapped log file" << endl;
+        return 1;
+    }
+    void* address = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (address == MAP_FAILED) {
+        cerr << "Error: Could not map " << path << endl;
+        return 1;
+    }
+    const char* file = (const char*)address;
+    
+    MappedLogHeader header;
+    memcpy(&header, file, sizeof(header));
+    if (memcmp(header.magic, MappedLogMagic, sizeof(MappedLogMagic)) != 0 || header.capacity == 0 ||
+        header.capacity % MappedRecordAlignment != 0 ||
+        MappedLogDataOffset + header.capacity > (uint64_t)info.st_size) {
+        cerr << "Error: " << path << " is not a mapped log file" << endl;
+        return 1;
+    }
+    
+    // Keep only the last `tail` lines when asked; otherwise stream everything
+    deque<string> kept;
+    size_t recovered = 0;
+    size_t skipped = forEachMappedRecord(file + MappedLogDataOffset, header.capacity, header.writePosition,
+                        [&](const MappedRecordHeader& record, const char* payload) {
+        string line = "[" + formatTimestamp(record.timestampMicros) + "] [" + levelName(record.level) + "] " +
+                      string(payload, record.length);
+        recovered++;
+        if (tail == 0) {
+            cout << line << '\n';
+            return;
+        }
+        kept.push_back(move(line));
+        if (kept.size() > tail) kept.pop_front();
+    });
+    for (const string& line : kept) {
+        cout << line << '\n';
+    }
+    cerr << recovered << " records recovered, " << skipped << " torn or overwritten skipped" << endl;
+    
+    munmap(address, info.st_size);
+    return 0;
+}
@@ -3,9 +3,46 @@
 #include <memory>
 #include <fstream>
 #include <ctime>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <string_view>
+#include <cstdio>
+#include <cmath>
+#include <climits>
+#include <cstdint>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <queue>
+#include <algorithm>
+#include <array>
+#include <sstream>
+#include <type_traits>
+#include <fcntl.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include <unistd.h>
+#include <spawn.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/mman.h>
+#include <csignal>
+#include <new>
+#ifdef __APPLE__
+#include <mach-o/dyld.h>
+#endif
+#include "binary_log_format.h"
+#include "mapped_log_format.h"
 
 using namespace std;
 
+extern char** environ;  // for posix_spawnp
+
 // Enum for log levels - better than static integers
 enum class LogLevel {
     INFO = 1,
@@ -15,8 +52,8 @@ enum class LogLevel {
     FATAL = 5
 };
 
-// Convert log level to string for display
-string logLevelToString(LogLevel level) {
+// Level name as a static string (no allocation)
+const char* logLevelName(LogLevel level) {
     switch(level) {
         case LogLevel::INFO: return "INFO";
         case LogLevel::DEBUG: return "DEBUG";
@@ -27,15 +64,143 @@ string logLevelToString(LogLevel level) {
     }
 }
 
+// Convert log level to string for display
+string logLevelToString(LogLevel level) {
+    return logLevelName(level);
+}
+
+// How log lines are stamped
+enum class TimestampMode {
+    WallClock,        // "Mon Oct 19 14:53:18 2026", the ctime layout
+    MonotonicMicros   // seconds since process start, to the microsecond: "12.000345"
+};
+
+atomic<TimestampMode> timestampMode{TimestampMode::WallClock};
+
+void setTimestampMode(TimestampMode mode) {
+    timestampMode.store(mode, memory_order_relaxed);
+}
+
+// An instant captured in the mode that was active at capture time:
+// wall-clock seconds or monotonic microseconds
+struct LogTimestamp {
+    int64_t value;
+    TimestampMode mode;
+};
+
+int64_t monotonicMicros() {
+    static const auto processStart = chrono::steady_clock::now();
+    return chrono::duration_cast<chrono::microseconds>(chrono::steady_clock::now() - processStart).count();
+}
+
+// Monotonic nanoseconds at millisecond-or-so resolution; much cheaper to read
+// than steady_clock where the kernel offers a coarse clock
+int64_t coarseMonotonicNanos() {
+#ifdef CLOCK_MONOTONIC_COARSE
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &now);
+    return now.tv_sec * 1000000000LL + now.tv_nsec;
+#else
+    return chrono::duration_cast<chrono::nanoseconds>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+LogTimestamp captureTimestamp() {
+    TimestampMode mode = timestampMode.load(memory_order_relaxed);
+    return {mode == TimestampMode::WallClock ? (int64_t)time(0) : monotonicMicros(), mode};
+}
+
+/**
+ * Per-thread timestamp renderer. The text for the current second is built
+ * (localtime_r + strftime, or the integer seconds) only when the second
+ * changes; every other call copies the cached bytes and, for monotonic
+ * stamps, appends six microsecond digits.
+ */
+class TimestampFormatter {
+private:
+    int64_t cachedWallSecond = -1;
+    char cachedWall[32];
+    size_t cachedWallLength = 0;
+    int64_t cachedMonotonicSecond = -1;
+    char cachedMonotonic[24];
+    size_t cachedMonotonicLength = 0;
+    
+public:
+    static const size_t MaxLength = 32;
+    
+    static TimestampFormatter& forThisThread() {
+        thread_local TimestampFormatter formatter;
+        return formatter;
+    }
+    
+    // Writes at most MaxLength bytes to out and returns the length
+    size_t render(LogTimestamp stamp, char* out) {
+        if (stamp.mode == TimestampMode::WallClock) {
+            if (stamp.value != cachedWallSecond) {
+                time_t second = (time_t)stamp.value;
+                tm parts;
+                localtime_r(&second, &parts);
+                cachedWallLength = strftime(cachedWall, sizeof(cachedWall), "%a %b %e %H:%M:%S %Y", &parts);
+                cachedWallSecond = stamp.value;
+            }
+            memcpy(out, cachedWall, cachedWallLength);
+            return cachedWallLength;
+        }
+        
+        int64_t second = stamp.value / 1000000;
+        if (second != cachedMonotonicSecond) {
+            cachedMonotonicLength = snprintf(cachedMonotonic, sizeof(cachedMonotonic), "%lld.", (long long)second);
+            cachedMonotonicSecond = second;
+        }
+        memcpy(out, cachedMonotonic, cachedMonotonicLength);
+        int fraction = (int)(stamp.value % 1000000);
+        for (int i = 5; i >= 0; i--) {
+            out[cachedMonotonicLength + i] = (char)('0' + fraction % 10);
+            fraction /= 10;
+        }
+        return cachedMonotonicLength + 6;
+    }
+};
+
 // Get current timestamp
 string getCurrentTimestamp() {
-    time_t now = time(0);
-    char* timeStr = ctime(&now);
-    string result(timeStr);
-    result.pop_back(); // Remove newline character
-    return result;
+    char buffer[TimestampFormatter::MaxLength];
+    size_t length = TimestampFormatter::forThisThread().render(captureTimestamp(), buffer);
+    return string(buffer, length);
 }
 
+// A formatted log line assembled on the stack; only lines longer than the
+// inline buffer spill over to the heap
+class FormattedMessage {
+private:
+    char inlineBuffer[256];
+    size_t length = 0;
+    string overflow;
+    
+public:
+    void append(const char* text, size_t count) {
+        if (overflow.empty() && length + count <= sizeof(inlineBuffer)) {
+            memcpy(inlineBuffer + length, text, count);
+            length += count;
+            return;
+        }
+        if (overflow.empty()) {
+            overflow.assign(inlineBuffer, length);
+        }
+        overflow.append(text, count);
+    }
+    
+    void append(string_view text) { append(text.data(), text.size()); }
+    
+    string_view view() const {
+        return overflow.empty() ? string_view(inlineBuffer, length) : string_view(overflow);
+    }
+    
+    friend ostream& operator<<(ostream& out, const FormattedMessage& formatted) {
+        return out << formatted.view();
+    }
+};
+
 /**
  * CHAIN OF RESPONSIBILITY DESIGN PATTERN
  * 
@@ -62,100 +227,1765 @@ protected:
     shared_ptr<Logger> nextLoggerInChain;  // Next handler in chain
     
 public:
-    Logger(LogLevel logLevel) : level(logLevel), nextLoggerInChain(nullptr) {}
+    Logger(LogLevel logLevel) : level(logLevel), nextLoggerInChain(nullptr) {}
+    
+    virtual ~Logger() = default;
+    
+    // Set the next logger in chain
+    void setNextLogger(shared_ptr<Logger> nextLogger) {
+        nextLoggerInChain = nextLogger;
+    }
+    
+    Logger* getNextLogger() const { return nextLoggerInChain.get(); }
+    
+    bool accepts(LogLevel msgLevel) const { return msgLevel >= level; }
+    
+    // Process the message in this handler only, without walking the chain
+    void handle(LogLevel msgLevel, const string& message) { writeMessage(msgLevel, message); }
+    
+    // Main method that implements Chain of Responsibility
+    void logMessage(LogLevel msgLevel, const string& message) {
+        // If current logger can handle this level, process it
+        if (msgLevel >= level) {
+            writeMessage(msgLevel, message);
+        }
+        
+        // Always pass to next logger in chain (if exists)
+        if (nextLoggerInChain != nullptr) {
+            nextLoggerInChain->logMessage(msgLevel, message);
+        }
+    }
+    
+protected:
+    // Pure virtual method - each concrete logger implements its own way
+    virtual void write(const string& message) = 0;
+    
+    // Entry point used by the chain; handlers that care about the message's
+    // own level (e.g. to flush on errors) override this instead of write()
+    virtual void writeMessage(LogLevel /*msgLevel*/, const string& message) {
+        write(message);
+    }
+    
+    // Helper method to format log message: "[timestamp] [LEVEL] message"
+    virtual FormattedMessage formatMessage(const string& message, LogLevel msgLevel) {
+        FormattedMessage formatted;
+        char stamp[TimestampFormatter::MaxLength];
+        formatted.append("[", 1);
+        formatted.append(stamp, TimestampFormatter::forThisThread().render(captureTimestamp(), stamp));
+        formatted.append("] [", 3);
+        formatted.append(logLevelName(msgLevel));
+        formatted.append("] ", 2);
+        formatted.append(message);
+        return formatted;
+    }
+};
+
+// Concrete Logger 1: Console Logger
+class ConsoleLogger : public Logger {
+public:
+    ConsoleLogger(LogLevel level) : Logger(level) {}
+    
+protected:
+    void write(const string& message) override {
+        cout << "CONSOLE: " << formatMessage(message, level) << endl;
+    }
+};
+
+/**
+ * CRASH SAFETY
+ *
+ * Sinks that hold messages in memory register with CrashFlusher. On the
+ * orderly FATAL path (LoggerManager::fatalAndAbort) every target drains
+ * synchronously before abort(). If the process dies on a fatal signal, the
+ * handler gives every target one last chance to salvage what it holds into
+ * memory the kernel will persist anyway (a MappedRingSink), using only
+ * memcpy-style work that is safe inside a signal handler.
+ */
+class CrashFlushTarget {
+public:
+    virtual ~CrashFlushTarget() = default;
+    
+    // Orderly shutdown: write out everything buffered, blocking as needed
+    virtual void drainForExit() = 0;
+    
+    // Inside a fatal-signal handler: no locks, no allocation
+    virtual void salvageOnCrash() = 0;
+};
+
+class CrashFlusher {
+private:
+    static const int MaxTargets = 32;
+    static atomic<CrashFlushTarget*> targets[MaxTargets];
+    static atomic<bool> crashing;
+    
+    static void handleFatalSignal(int signalNumber) {
+        if (!crashing.exchange(true)) {
+            for (auto& target : targets) {
+                CrashFlushTarget* current = target.load(memory_order_acquire);
+                if (current != nullptr) current->salvageOnCrash();
+            }
+        }
+        // SA_RESETHAND restored the default action: re-raise to die as we would have
+        raise(signalNumber);
+    }
+    
+public:
+    // Installs the handler for SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT
+    static void installSignalHandlers() {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = handleFatalSignal;
+        action.sa_flags = SA_RESETHAND;
+        sigemptyset(&action.sa_mask);
+        for (int signalNumber : {SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT}) {
+            sigaction(signalNumber, &action, nullptr);
+        }
+    }
+    
+    static void add(CrashFlushTarget* target) {
+        for (auto& slot : targets) {
+            CrashFlushTarget* empty = nullptr;
+            if (slot.compare_exchange_strong(empty, target)) return;
+        }
+        cerr << "Warning: too many crash flush targets; one will not be salvaged" << endl;
+    }
+    
+    static void remove(CrashFlushTarget* target) {
+        for (auto& slot : targets) {
+            CrashFlushTarget* expected = target;
+            slot.compare_exchange_strong(expected, nullptr);
+        }
+    }
+    
+    static void drainAll() {
+        for (auto& target : targets) {
+            CrashFlushTarget* current = target.load(memory_order_acquire);
+            if (current != nullptr) current->drainForExit();
+        }
+    }
+};
+
+atomic<CrashFlushTarget*> CrashFlusher::targets[CrashFlusher::MaxTargets];
+atomic<bool> CrashFlusher::crashing{false};
+
+// When a RotatingFileSink pushes its buffer to the file
+enum class FlushPolicy {
+    EveryMessage,  // write(2) after every line
+    Periodic,      // background flush every flushInterval (and whenever the buffer fills)
+    OnError        // flush on ERROR/FATAL lines (and whenever the buffer fills)
+};
+
+struct RotationConfig {
+    size_t maxFileBytes = 10 * 1024 * 1024;     // rotate once the live file would exceed this
+    chrono::seconds maxFileAge = chrono::hours(24);
+    size_t maxRotatedSegments = 5;              // older rotated segments are deleted
+    bool compressRotated = true;                // gzip rotated segments in the background
+    FlushPolicy flushPolicy = FlushPolicy::EveryMessage;
+    chrono::milliseconds flushInterval = chrono::milliseconds(1000);
+    size_t bufferBytes = 64 * 1024;
+};
+
+/**
+ * ROTATING FILE SINK
+ *
+ * Appends lines to a file descriptor that stays open, through an in-memory
+ * buffer drained according to the flush policy. When the live file grows
+ * past maxFileBytes or gets older than maxFileAge it is renamed to
+ * "<path>.<yyyymmdd-hhmmss>.<n>" and a fresh file is opened. A maintenance
+ * thread gzips rotated segments, prunes old ones and runs periodic flushes.
+ *
+ * Sinks are shared per path (forPath) so chains rebuilt at runtime do not end
+ * up with two buffers and two rotation schedules for the same file.
+ */
+class RotatingFileSink : public CrashFlushTarget {
+private:
+    string path;
+    RotationConfig config;
+    
+    mutex sinkMutex;  // guards everything down to rotationCount
+    int fd = -1;
+    string buffer;
+    size_t fileBytes = 0;  // written + buffered bytes of the live file
+    chrono::steady_clock::time_point openedAt;
+    uint64_t rotationCount = 0;
+    
+    mutex maintenanceMutex;  // guards the queues and stopping
+    condition_variable maintenanceReady;
+    deque<string> pendingCompression;
+    deque<string> retainedSegments;
+    bool compressing = false;
+    bool stopping = false;
+    thread maintenance;
+    
+    void openLiveFile() {
+        fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            cerr << "Error: Could not open file " << path << endl;
+        }
+        struct stat info;
+        fileBytes = (fd >= 0 && fstat(fd, &info) == 0) ? (size_t)info.st_size : 0;
+        openedAt = chrono::steady_clock::now();
+    }
+    
+    void flushLocked() {
+        const char* data = buffer.data();
+        size_t remaining = buffer.size();
+        while (remaining > 0 && fd >= 0) {
+            ssize_t count = ::write(fd, data, remaining);
+            if (count <= 0) break;
+            data += count;
+            remaining -= count;
+        }
+        buffer.clear();
+    }
+    
+    bool rotationDue(size_t incomingBytes) const {
+        if (fileBytes == 0) return false;
+        return fileBytes + incomingBytes > config.maxFileBytes ||
+               chrono::steady_clock::now() - openedAt >= config.maxFileAge;
+    }
+    
+    void rotateLocked() {
+        flushLocked();
+        if (fd >= 0) close(fd);
+        
+        char stamp[32];
+        time_t now = time(0);
+        tm parts;
+        localtime_r(&now, &parts);
+        strftime(stamp, sizeof(stamp), "%Y%m%d-%H%M%S", &parts);
+        string segment = path + "." + stamp + "." + to_string(++rotationCount);
+        if (rename(path.c_str(), segment.c_str()) != 0) {
+            cerr << "Error: Could not rotate " << path << endl;
+        }
+        openLiveFile();
+        
+        lock_guard<mutex> lock(maintenanceMutex);
+        if (config.compressRotated) {
+            pendingCompression.push_back(segment);
+            maintenanceReady.notify_one();
+        } else {
+            retainSegment(segment);
+        }
+    }
+    
+    // Caller holds maintenanceMutex
+    void retainSegment(const string& segment) {
+        retainedSegments.push_back(segment);
+        while (retainedSegments.size() > config.maxRotatedSegments) {
+            unlink(retainedSegments.front().c_str());
+            retainedSegments.pop_front();
+        }
+    }
+    
+    // Runs `gzip -f <segment>`; returns the name of the file that now holds the segment
+    static string compressSegment(const string& segment) {
+        const char* args[] = {"gzip", "-f", "-q", segment.c_str(), nullptr};
+        pid_t child;
+        if (posix_spawnp(&child, "gzip", nullptr, nullptr, (char* const*)args, environ) != 0) {
+            return segment;  // no gzip available: keep the segment uncompressed
+        }
+        int status = 0;
+        waitpid(child, &status, 0);
+        return (WIFEXITED(status) && WEXITSTATUS(status) == 0) ? segment + ".gz" : segment;
+    }
+    
+    void maintenanceLoop() {
+        unique_lock<mutex> lock(maintenanceMutex);
+        while (true) {
+            maintenanceReady.wait_for(lock, config.flushInterval, [this]() {
+                return stopping || !pendingCompression.empty();
+            });
+            while (!pendingCompression.empty()) {
+                string segment = pendingCompression.front();
+                pendingCompression.pop_front();
+                compressing = true;
+                lock.unlock();
+                string stored = compressSegment(segment);
+                lock.lock();
+                retainSegment(stored);
+                compressing = false;
+            }
+            if (stopping) break;
+            
+            lock.unlock();
+            {
+                lock_guard<mutex> sinkLock(sinkMutex);
+                if (config.flushPolicy == FlushPolicy::Periodic) {
+                    flushLocked();
+                }
+                if (chrono::steady_clock::now() - openedAt >= config.maxFileAge && fileBytes > 0) {
+                    rotateLocked();
+                }
+            }
+            lock.lock();
+        }
+    }
+    
+public:
+    RotatingFileSink(const string& path, const RotationConfig& config = RotationConfig())
+        : path(path), config(config) {
+        buffer.reserve(config.bufferBytes);
+        openLiveFile();
+        maintenance = thread(&RotatingFileSink::maintenanceLoop, this);
+        CrashFlusher::add(this);
+    }
+    
+    ~RotatingFileSink() {
+        CrashFlusher::remove(this);
+        {
+            lock_guard<mutex> lock(maintenanceMutex);
+            stopping = true;
+        }
+        maintenanceReady.notify_one();
+        maintenance.join();  // finishes pending compressions first
+        flushLocked();
+        if (fd >= 0) close(fd);
+    }
+    
+    // Shared sink for a path, created with `config` if nobody holds one yet
+    static shared_ptr<RotatingFileSink> forPath(const string& path, const RotationConfig& config = RotationConfig()) {
+        static mutex registryMutex;
+        static map<string, weak_ptr<RotatingFileSink>> sinks;
+        lock_guard<mutex> lock(registryMutex);
+        shared_ptr<RotatingFileSink> sink = sinks[path].lock();
+        if (!sink) {
+            sink = make_shared<RotatingFileSink>(path, config);
+            sinks[path] = sink;
+        }
+        return sink;
+    }
+    
+    // Appends one line (a newline is added)
+    void append(LogLevel msgLevel, string_view line) {
+        lock_guard<mutex> lock(sinkMutex);
+        if (rotationDue(line.size() + 1)) {
+            rotateLocked();
+        }
+        buffer.append(line.data(), line.size());
+        buffer += '\n';
+        fileBytes += line.size() + 1;
+        if (config.flushPolicy == FlushPolicy::EveryMessage || buffer.size() >= config.bufferBytes ||
+            (config.flushPolicy == FlushPolicy::OnError && msgLevel >= LogLevel::ERROR)) {
+            flushLocked();
+        }
+    }
+    
+    void flush() {
+        lock_guard<mutex> lock(sinkMutex);
+        flushLocked();
+    }
+    
+    // Blocks until every rotated segment handed over so far is compressed
+    void waitForMaintenance() {
+        unique_lock<mutex> lock(maintenanceMutex);
+        while (!pendingCompression.empty() || compressing) {
+            lock.unlock();
+            this_thread::sleep_for(chrono::milliseconds(1));
+            lock.lock();
+        }
+    }
+    
+    void drainForExit() override {
+        flush();
+    }
+    
+    // write(2) is async-signal-safe; the buffer may be mid-append, so this is best effort
+    void salvageOnCrash() override {
+        if (fd >= 0 && !buffer.empty()) {
+            ssize_t ignored = ::write(fd, buffer.data(), buffer.size());
+            (void)ignored;
+        }
+    }
+    
+    const string& getPath() const { return path; }
+    
+    vector<string> getRetainedSegments() {
+        lock_guard<mutex> lock(maintenanceMutex);
+        return vector<string>(retainedSegments.begin(), retainedSegments.end());
+    }
+};
+
+// Concrete Logger 2: File Logger (writes through a shared RotatingFileSink)
+class FileLogger : public Logger {
+private:
+    shared_ptr<RotatingFileSink> sink;
+    
+public:
+    FileLogger(LogLevel level, const string& file) : Logger(level), sink(RotatingFileSink::forPath(file)) {}
+    
+    FileLogger(LogLevel level, shared_ptr<RotatingFileSink> sink) : Logger(level), sink(sink) {}
+    
+protected:
+    void write(const string& message) override {
+        writeMessage(level, message);
+    }
+    
+    void writeMessage(LogLevel msgLevel, const string& message) override {
+        FormattedMessage formatted;
+        formatted.append("FILE: ", 6);
+        formatted.append(formatMessage(message, level).view());
+        sink->append(msgLevel, formatted.view());
+        cout << "Message logged to file: " << sink->getPath() << endl;
+    }
+};
+
+// How ErrorLogger limits alerts
+struct AlertPolicy {
+    double alertsPerSecond = 1.0;  // sustained alerts per message template
+    int burst = 5;                 // alerts a template may send back to back
+    chrono::seconds dedupeWindow = chrono::seconds(10);     // identical messages alert once per window
+    chrono::seconds summaryInterval = chrono::seconds(10);  // how often suppression counts are reported
+};
+
+/**
+ * ALERT THROTTLE
+ *
+ * Decides whether an error may raise an alert, without locks or allocation:
+ * - the message is hashed twice in one pass: as a template with every run of
+ *   digits collapsed ("timeout after 31 ms" and "timeout after 4500 ms" share
+ *   a template), and exactly (the template plus the digits and where they
+ *   sit). Text between digit runs is hashed eight bytes at a time;
+ * - exact repeats within dedupeWindow are caught by a count-min sketch of
+ *   recent message hashes (cleared when the window rolls over). Its counters
+ *   are bumped with plain loads and stores: an increment lost to a race
+ *   only makes the estimate lower, which a sketch tolerates;
+ * - each template gets a token bucket, packed with its last refill time
+ *   (on the coarse monotonic clock) into one atomic word.
+ * Suppressed alerts are counted per template and reported as
+ * "N alerts suppressed" summaries every summaryInterval. Templates live in a
+ * fixed table probed by signature; once it is crowded, new templates share
+ * one overflow bucket.
+ */
+class AlertThrottle {
+private:
+    static const size_t TemplateSlots = 1024;  // plus one overflow slot at the end
+    static const int MaxProbes = 16;
+    static const size_t SketchWidth = 4096;
+    static const int SketchDepth = 4;
+    static const size_t SampleBytes = 120;
+    static const int UnitShift = 10;  // bucket clock unit: 1024 ns
+    static const uint64_t MilliTokenMask = (1u << 24) - 1;
+    static const uint64_t UnitMask = (1ull << 40) - 1;
+    
+    struct TemplateSlot {
+        atomic<uint64_t> signature{0};
+        atomic<uint64_t> bucket{0};  // (clock unit << 24) | milli-tokens; 0 = not started
+        atomic<uint32_t> suppressed{0};
+        atomic<bool> sampleReady{false};
+        char sample[SampleBytes];
+        uint16_t sampleLength = 0;
+    };
+    
+    uint64_t burstMilliTokens;
+    double milliTokensPerUnit;
+    int64_t dedupeWindowNanos;
+    int64_t summaryIntervalNanos;
+    unique_ptr<TemplateSlot[]> slots;
+    unique_ptr<atomic<uint32_t>[]> sketch;  // SketchDepth rows of SketchWidth counters
+    atomic<int64_t> windowStart;
+    atomic<int64_t> nextSummary;
+    
+    static uint64_t mix(uint64_t hash, uint64_t value) {
+        hash = (hash ^ value) * 0x9E3779B97F4A7C15ull;
+        return hash ^ (hash >> 29);
+    }
+    
+    // Bit 7 of each byte of the result is set where the byte of `word` is an ASCII digit
+    static uint64_t digitBytes(uint64_t word) {
+        const uint64_t lowSeven = 0x7F7F7F7F7F7F7F7Full;
+        uint64_t t = ((word & 0xF0F0F0F0F0F0F0F0ull) ^ 0x3030303030303030ull) |
+                     (((word & 0x0F0F0F0F0F0F0F0Full) + 0x0606060606060606ull) & 0x1010101010101010ull);
+        return ~(((t & lowSeven) + lowSeven) | t | lowSeven);  // exact zero-byte test on t
+    }
+    
+    static void hashMessage(string_view message, uint64_t& exact, uint64_t& templ) {
+        const char* data = message.data();
+        size_t length = message.size(), pos = 0;
+        uint64_t digits = 0;
+        templ = 0x243F6A8885A308D3ull;
+        while (pos < length) {
+            // Hash the text up to the next digit, a word at a time
+            size_t start = pos;
+            uint64_t word = 0;
+            while (pos < length) {
+                size_t take = 8;
+                if (length - pos >= 8) {
+                    memcpy(&word, data + pos, 8);
+                } else {
+                    take = length - pos;
+                    word = 0;
+                    for (size_t i = 0; i < take; i++) {
+                        word |= (uint64_t)(unsigned char)data[pos + i] << (i * 8);
+                    }
+                }
+                uint64_t found = digitBytes(word);
+                if (found != 0) {
+                    size_t offset = __builtin_ctzll(found) / 8;  // little-endian byte order
+                    word &= offset == 0 ? 0 : ~0ull >> (64 - offset * 8);
+                    pos += offset;
+                    break;
+                }
+                pos += take;
+                if (take < 8) break;
+                templ = mix(templ, word);
+                word = 0;
+            }
+            templ = mix(templ, word ^ ((uint64_t)(pos - start) << 56));
+            if (pos >= length) break;
+            
+            // Collapse the digit run into one marker, remembering its value and position
+            templ = mix(templ, '#');
+            digits = mix(digits, pos);
+            while (pos < length && data[pos] >= '0' && data[pos] <= '9') {
+                digits = digits * 10 + (data[pos] - '0');
+                pos++;
+            }
+        }
+        exact = mix(templ, digits);
+    }
+    
+    // Counts this occurrence and returns how often the message was already seen in the window
+    uint32_t countRecent(uint64_t exact, int64_t now) {
+        int64_t start = windowStart.load(memory_order_relaxed);
+        if (now - start >= dedupeWindowNanos && windowStart.compare_exchange_strong(start, now)) {
+            for (size_t i = 0; i < SketchDepth * SketchWidth; i++) {
+                sketch[i].store(0, memory_order_relaxed);
+            }
+        }
+        uint32_t seen = UINT32_MAX;
+        uint64_t h1 = exact, h2 = (exact >> 32) | 1;
+        for (int row = 0; row < SketchDepth; row++) {
+            size_t column = (h1 + row * h2) & (SketchWidth - 1);
+            atomic<uint32_t>& counter = sketch[row * SketchWidth + column];
+            uint32_t count = counter.load(memory_order_relaxed);
+            counter.store(count + 1, memory_order_relaxed);
+            seen = min(seen, count);
+        }
+        return seen;
+    }
+    
+    bool takeToken(TemplateSlot& slot, int64_t now) {
+        uint64_t unit = ((uint64_t)now >> UnitShift) & UnitMask;
+        uint64_t state = slot.bucket.load(memory_order_relaxed);
+        while (true) {
+            uint64_t last = state >> 24;
+            uint64_t tokens = state & MilliTokenMask;
+            if (state == 0) {
+                last = unit;
+                tokens = burstMilliTokens;
+            }
+            // Credit whole milli-tokens only and keep the clock where it was
+            // otherwise, so a storm of calls still accumulates refill time
+            uint64_t credit = (uint64_t)(((unit - last) & UnitMask) * milliTokensPerUnit);
+            if (credit > 0) {
+                tokens = min(burstMilliTokens, tokens + credit);
+                last = unit;
+            }
+            bool allowed = tokens >= 1000;
+            uint64_t updated = (last << 24) | (allowed ? tokens - 1000 : tokens);
+            if (updated == state) return allowed;
+            if (slot.bucket.compare_exchange_weak(state, updated, memory_order_relaxed)) return allowed;
+        }
+    }
+    
+    // Open addressing with linear probing; a template that finds neither its
+    // own slot nor a free one within MaxProbes shares the overflow slot
+    TemplateSlot& slotFor(uint64_t templ, string_view message) {
+        uint64_t signature = templ | 1;  // never 0, which marks a free slot
+        for (int probe = 0; probe < MaxProbes; probe++) {
+            TemplateSlot& slot = slots[(templ + probe) & (TemplateSlots - 1)];
+            uint64_t current = slot.signature.load(memory_order_acquire);
+            if (current == 0 && slot.signature.compare_exchange_strong(current, signature)) {
+                slot.sampleLength = (uint16_t)min(message.size(), SampleBytes);
+                memcpy(slot.sample, message.data(), slot.sampleLength);
+                slot.sampleReady.store(true, memory_order_release);
+                return slot;
+            }
+            if (current == signature) {
+                return slot;
+            }
+        }
+        return slots[TemplateSlots];
+    }
+    
+public:
+    explicit AlertThrottle(const AlertPolicy& policy = AlertPolicy())
+        : slots(new TemplateSlot[TemplateSlots + 1]), sketch(new atomic<uint32_t>[SketchDepth * SketchWidth]) {
+        TemplateSlot& overflow = slots[TemplateSlots];
+        const char overflowSample[] = "(templates beyond the alert table)";
+        overflow.sampleLength = sizeof(overflowSample) - 1;
+        memcpy(overflow.sample, overflowSample, overflow.sampleLength);
+        overflow.sampleReady.store(true, memory_order_release);
+        burstMilliTokens = (uint64_t)policy.burst * 1000;
+        milliTokensPerUnit = policy.alertsPerSecond * 1000 * (1 << UnitShift) / 1e9;
+        dedupeWindowNanos = chrono::duration_cast<chrono::nanoseconds>(policy.dedupeWindow).count();
+        summaryIntervalNanos = chrono::duration_cast<chrono::nanoseconds>(policy.summaryInterval).count();
+        for (size_t i = 0; i < SketchDepth * SketchWidth; i++) {
+            sketch[i].store(0, memory_order_relaxed);
+        }
+        int64_t now = coarseMonotonicNanos();
+        windowStart.store(now);
+        nextSummary.store(now + summaryIntervalNanos);
+    }
+    
+    // True if this message may raise an alert; otherwise it is counted as suppressed
+    bool admit(string_view message) {
+        uint64_t exact, templ;
+        hashMessage(message, exact, templ);
+        int64_t now = coarseMonotonicNanos();
+        TemplateSlot& slot = slotFor(templ, message);
+        bool duplicate = countRecent(exact, now) > 0;
+        if (!duplicate && takeToken(slot, now)) {
+            return true;
+        }
+        slot.suppressed.fetch_add(1, memory_order_relaxed);
+        return false;
+    }
+    
+    // True once per summaryInterval, for exactly one caller
+    bool claimSummary() {
+        int64_t now = coarseMonotonicNanos();
+        int64_t due = nextSummary.load(memory_order_relaxed);
+        return now >= due && nextSummary.compare_exchange_strong(due, now + summaryIntervalNanos);
+    }
+    
+    // "N alerts suppressed" lines for every template with suppressed alerts; resets the counts
+    vector<string> collectSummaries() {
+        vector<string> summaries;
+        for (size_t i = 0; i <= TemplateSlots; i++) {
+            TemplateSlot& slot = slots[i];
+            if (slot.suppressed.load(memory_order_relaxed) == 0) continue;
+            uint32_t count = slot.suppressed.exchange(0, memory_order_relaxed);
+            string sample = slot.sampleReady.load(memory_order_acquire)
+                ? string(slot.sample, slot.sampleLength) : string("(unknown)");
+            if (count > 0) {
+                summaries.push_back(to_string(count) + " alerts suppressed, like: " + sample);
+            }
+        }
+        return summaries;
+    }
+};
+
+// Concrete Logger 3: Error Logger (for critical errors), with alerts throttled per message template
+class ErrorLogger : public Logger {
+private:
+    AlertThrottle throttle;
+    
+    void reportSuppressed() {
+        for (const string& summary : throttle.collectSummaries()) {
+            cerr << "ERROR LOG: " << formatMessage(summary, level) << endl;
+        }
+    }
+    
+public:
+    ErrorLogger(LogLevel level, const AlertPolicy& policy = AlertPolicy()) : Logger(level), throttle(policy) {}
+    
+    ~ErrorLogger() {
+        reportSuppressed();
+    }
+    
+protected:
+    void write(const string& message) override {
+        writeMessage(level, message);
+    }
+    
+    // Every error is logged; only the alert is throttled, and FATAL always alerts
+    void writeMessage(LogLevel msgLevel, const string& message) override {
+        if (throttle.claimSummary()) {
+            reportSuppressed();
+        }
+        cerr << "ERROR LOG: " << formatMessage(message, level) << endl;
+        if (msgLevel == LogLevel::FATAL || throttle.admit(message)) {
+            // Could also send email, SMS, or other critical notifications
+            cout << "*** CRITICAL ERROR ALERT SENT ***" << endl;
+        }
+    }
+};
+
+// Concrete Logger 4: Debug Logger (detailed debugging info)
+class DebugLogger : public Logger {
+public:
+    DebugLogger(LogLevel level) : Logger(level) {}
+    
+protected:
+    void write(const string& message) override {
+        cout << "DEBUG: " << formatMessage(message, level) << " [PID: " << 
+               getpid() << "]" << endl;
+    }
+    
+private:
+    int getpid() {
+        // Simulate process ID
+        return 12345;
+    }
+};
+
+// What a full async ring does with a new message
+enum class OverflowPolicy {
+    Block,   // caller waits for a free slot; nothing is lost
+    Drop,    // message is discarded and counted
+    Sample   // keep one in every `sampleEvery` messages (blocking for it), drop the rest
+};
+
+/**
+ * MPSC RING
+ *
+ * Bounded lock-free multi-producer / single-consumer ring of fixed-size
+ * records. Every slot carries a sequence number: a producer claims a slot
+ * with one CAS on enqueuePos, fills it and publishes it by bumping the
+ * slot's sequence; the consumer reads slots strictly in order and hands
+ * them back by advancing the sequence one lap. Reading and handing back are
+ * separate steps, so a record stays in the ring until the consumer is done
+ * with it (e.g. has written it out).
+ */
+template <typename Record>
+class MpscRing {
+private:
+    struct alignas(64) Slot {
+        atomic<uint64_t> sequence;
+        Record record;
+    };
+    
+    unique_ptr<Slot[]> slots;
+    uint64_t mask;
+    alignas(64) atomic<uint64_t> enqueuePos{0};
+    alignas(64) atomic<uint64_t> dequeuePos{0};  // first slot not handed back; written by the consumer only
+    uint64_t readPos = 0;                        // consumer only: first slot not yet read
+    
+public:
+    // capacity is rounded up to a power of two
+    explicit MpscRing(size_t capacity) {
+        size_t size = 1;
+        while (size < capacity) size <<= 1;
+        slots.reset(new Slot[size]);
+        mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            slots[i].sequence.store(i, memory_order_relaxed);
+        }
+    }
+    
+    // Claims a slot and lets fill(Record&) populate it; false when the ring is full
+    template <typename Fill>
+    bool tryPush(Fill&& fill) {
+        uint64_t pos = enqueuePos.load(memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots[pos & mask];
+            uint64_t seq = slot.sequence.load(memory_order_acquire);
+            int64_t diff = (int64_t)seq - (int64_t)pos;
+            if (diff == 0) {
+                if (enqueuePos.compare_exchange_weak(pos, pos + 1, memory_order_relaxed)) {
+                    fill(slot.record);
+                    slot.sequence.store(pos + 1, memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueuePos.load(memory_order_relaxed);
+            }
+        }
+    }
+    
+    // Consumer only: passes published records to consume(const Record&) in
+    // order, keeping their slots, until the ring runs dry or consume returns false
+    template <typename Consume>
+    size_t read(Consume&& consume) {
+        size_t count = 0;
+        while (true) {
+            Slot& slot = slots[readPos & mask];
+            if (slot.sequence.load(memory_order_acquire) != readPos + 1) break;
+            bool more = consume(slot.record);
+            readPos++;
+            count++;
+            if (!more) break;
+        }
+        return count;
+    }
+    
+    // Consumer only: hands back every slot read so far, passing each record to
+    // retire(const Record&) first; returns the number handed back
+    template <typename Retire>
+    size_t release(Retire&& retire) {
+        uint64_t pos = dequeuePos.load(memory_order_relaxed);
+        size_t count = readPos - pos;
+        for (; pos < readPos; pos++) {
+            Slot& slot = slots[pos & mask];
+            retire(slot.record);
+            slot.sequence.store(pos + mask + 1, memory_order_release);
+        }
+        dequeuePos.store(readPos, memory_order_release);
+        return count;
+    }
+    
+    // Visits records published but not yet handed back, without consuming
+    // them. Meant for last-chance salvage in a crash, with the consumer stopped
+    template <typename Visit>
+    void peekUnreleased(Visit&& visit) const {
+        uint64_t end = enqueuePos.load(memory_order_acquire);
+        for (uint64_t pos = dequeuePos.load(memory_order_acquire); pos < end; pos++) {
+            const Slot& slot = slots[pos & mask];
+            if (slot.sequence.load(memory_order_acquire) == pos + 1) {
+                visit(slot.record);
+            }
+        }
+    }
+    
+    // Slots claimed so far (published or about to be)
+    uint64_t getClaimedCount() const { return enqueuePos.load(memory_order_acquire); }
+};
+
+/**
+ * RING FILE WRITER
+ *
+ * Shared plumbing of the async sinks. Producers push records into an
+ * MpscRing and return; a background thread drains it, lets the subclass
+ * encode each record into `batch` and writes every batch with one write()
+ * to a file descriptor that stays open for the sink's lifetime.
+ *
+ * Subclasses call start() at the end of their constructor and stop() first
+ * thing in their destructor, so the thread never sees a partly built or
+ * partly destroyed object.
+ */
+template <typename Record>
+class RingFileWriter {
+private:
+    MpscRing<Record> ring;
+    OverflowPolicy policy;
+    uint64_t sampleEvery;
+    atomic<uint64_t> overflows{0};
+    atomic<uint64_t> dropped{0};
+    atomic<uint64_t> written{0};
+    atomic<bool> running{false};
+    atomic<bool> frozen{false};     // set by a crash handler: write nothing more
+    atomic<bool> parked{false};     // the writer has seen `frozen` and stopped
+    uint64_t droppedReported = 0;   // consumer only
+    thread writer;
+    
+    // Writes the batch, then hands its records' slots back to the ring: until
+    // then a crash can still salvage them, and after it none is salvaged twice
+    void writeBatch() {
+        const char* data = batch.data();
+        size_t remaining = batch.size();
+        while (remaining > 0) {
+            ssize_t count = ::write(fd, data, remaining);
+            if (count <= 0) break;
+            data += count;
+            remaining -= count;
+        }
+        batch.clear();
+        size_t released = ring.release([this](const Record& record) { retireRecord(record); });
+        written.fetch_add(released, memory_order_release);
+    }
+    
+    // Consumer: stops for good once a crash handler has frozen the writer
+    void parkIfFrozen() {
+        if (!frozen.load(memory_order_acquire)) return;
+        parked.store(true, memory_order_release);
+        while (true) {
+            this_thread::sleep_for(chrono::seconds(1));
+        }
+    }
+    
+    // Consumer: encodes every published record and writes it out; returns records drained
+    size_t drainOnce() {
+        size_t drained = 0;
+        while (true) {
+            drained += ring.read([this](const Record& record) {
+                appendRecord(record);
+                return batch.size() < 64 * 1024;
+            });
+            if (batch.size() < 64 * 1024) break;
+            parkIfFrozen();
+            writeBatch();
+        }
+        uint64_t droppedNow = dropped.load(memory_order_relaxed);
+        if (droppedNow != droppedReported) {
+            appendDropNotice(droppedNow - droppedReported);
+            droppedReported = droppedNow;
+        }
+        if (!batch.empty()) {
+            parkIfFrozen();
+            writeBatch();
+        }
+        return drained;
+    }
+    
+    void writerLoop() {
+        while (running.load(memory_order_acquire)) {
+            parkIfFrozen();
+            if (drainOnce() == 0) {
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+        }
+        drainOnce();
+    }
+    
+protected:
+    int fd;
+    string batch;  // consumer only
+    
+    RingFileWriter(const string& filename, size_t capacity, OverflowPolicy policy, uint64_t sampleEvery)
+        : ring(capacity), policy(policy), sampleEvery(sampleEvery) {
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            cerr << "Error: Could not open file " << filename << endl;
+        }
+    }
+    
+    virtual ~RingFileWriter() {
+        if (fd >= 0) close(fd);
+    }
+    
+    void start() {
+        running.store(true, memory_order_release);
+        writer = thread(&RingFileWriter::writerLoop, this);
+    }
+    
+    void stop() {
+        running.store(false, memory_order_release);
+        if (writer.joinable()) writer.join();
+    }
+    
+    // Consumer side: append the encoded record / a note about dropped records to batch
+    virtual void appendRecord(const Record& record) = 0;
+    virtual void appendDropNotice(uint64_t count) = 0;
+    
+    // Consumer side: the record has been written and its slot is about to be reused
+    virtual void retireRecord(const Record& /*record*/) {}
+    
+    // Applies the overflow policy; returns false if the record was dropped
+    template <typename Fill>
+    bool pushRecord(Fill&& fill) {
+        if (ring.tryPush(fill)) {
+            return true;
+        }
+        if (policy == OverflowPolicy::Drop ||
+            (policy == OverflowPolicy::Sample && overflows.fetch_add(1, memory_order_relaxed) % sampleEvery != 0)) {
+            dropped.fetch_add(1, memory_order_relaxed);
+            return false;
+        }
+        while (!ring.tryPush(fill)) {
+            this_thread::yield();
+        }
+        return true;
+    }
+    
+public:
+    // Blocks until everything pushed so far has been written
+    void flush() {
+        uint64_t target = ring.getClaimedCount();
+        while (written.load(memory_order_acquire) < target) {
+            this_thread::sleep_for(chrono::microseconds(100));
+        }
+    }
+    
+    uint64_t getDroppedCount() { return dropped.load(memory_order_relaxed); }
+    
+protected:
+    // Crash handler: stops the writer between batches, so the ring holds
+    // exactly the records not yet written. Gives up after half a second (a
+    // write() stuck on a slow disk) and does not wait if the writer itself
+    // crashed; only atomics and clock_gettime, so async-signal-safe
+    void freezeWriter() {
+        frozen.store(true, memory_order_release);
+        if (!writer.joinable() || pthread_equal(pthread_self(), writer.native_handle())) return;
+        timespec start, now;
+        clock_gettime(CLOCK_MONOTONIC, &start);
+        while (!parked.load(memory_order_acquire)) {
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            if ((now.tv_sec - start.tv_sec) * 1000000000LL + (now.tv_nsec - start.tv_nsec) > 500000000LL) return;
+        }
+    }
+    
+    // Records pushed but not yet written; call freezeWriter() first
+    template <typename Visit>
+    void visitUnwritten(Visit&& visit) const {
+        ring.peekUnreleased(visit);
+    }
+};
+
+/**
+ * MAPPED RING SINK
+ *
+ * Records are copied straight into a MAP_SHARED file mapping laid out as in
+ * mapped_log_format.h, so they sit in the page cache the moment append()
+ * returns and survive the process dying at any point after that. Writers
+ * reserve space with one fetch_add on the shared write position; the oldest
+ * records are overwritten once the ring wraps. log_recover.cpp extracts the
+ * surviving tail after a crash.
+ */
+class MappedRingSink : public CrashFlushTarget {
+private:
+    struct SharedHeader {
+        char magic[8];
+        uint64_t capacity;
+        atomic<uint64_t> writePosition;
+    };
+    static_assert(sizeof(SharedHeader) == sizeof(MappedLogHeader), "must match the on-disk header");
+    static_assert(atomic<uint64_t>::is_always_lock_free, "the write position lives in shared memory");
+    
+    size_t mappedBytes = 0;
+    char* mapping = nullptr;
+    SharedHeader* header = nullptr;
+    char* ring = nullptr;
+    uint64_t capacity = 0;
+    
+    void copyToRing(uint64_t offset, const void* data, size_t count) {
+        size_t first = (size_t)min<uint64_t>(capacity - offset, count);
+        memcpy(ring + offset, data, first);
+        memcpy(ring, (const char*)data + first, count - first);
+    }
+    
+public:
+    // Maps (creating or resetting) `filename` with a ring of capacityBytes
+    MappedRingSink(const string& filename, size_t capacityBytes = 4 << 20) {
+        capacity = (capacityBytes + MappedRecordAlignment - 1) & ~(uint64_t)(MappedRecordAlignment - 1);
+        mappedBytes = MappedLogDataOffset + capacity;
+        int fd = open(filename.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0 || ftruncate(fd, mappedBytes) != 0) {
+            cerr << "Error: Could not create mapped log " << filename << endl;
+            if (fd >= 0) close(fd);
+            return;
+        }
+        void* address = mmap(nullptr, mappedBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);  // the mapping keeps the file alive
+        if (address == MAP_FAILED) {
+            cerr << "Error: Could not map " << filename << endl;
+            return;
+        }
+        mapping = (char*)address;
+        header = new (mapping) SharedHeader();
+        header->capacity = capacity;
+        header->writePosition.store(0, memory_order_relaxed);
+        ring = mapping + MappedLogDataOffset;
+        memcpy(header->magic, MappedLogMagic, sizeof(MappedLogMagic));
+        CrashFlusher::add(this);
+    }
+    
+    ~MappedRingSink() {
+        CrashFlusher::remove(this);
+        if (mapping != nullptr) {
+            msync(mapping, mappedBytes, MS_ASYNC);
+            munmap(mapping, mappedBytes);
+        }
+    }
+    
+    // Lock-free and allocation-free, so it is also usable from a signal handler
+    void append(LogLevel msgLevel, string_view message, int64_t timestampMicros) {
+        if (mapping == nullptr) return;
+        uint32_t length = (uint32_t)min<size_t>(message.size(), min<uint64_t>(capacity / 4, 1 << 16));
+        uint64_t span = mappedRecordSpan(length);
+        uint64_t position = header->writePosition.fetch_add(span, memory_order_relaxed);
+        uint64_t offset = position % capacity;
+        
+        MappedRecordHeader record;
+        memset(&record, 0, sizeof(record));
+        record.length = length;
+        record.position = position;
+        record.timestampMicros = timestampMicros;
+        record.level = (uint8_t)msgLevel;
+        record.checksum = mappedRecordChecksum(record, message.data());
+        
+        copyToRing((offset + sizeof(record)) % capacity, message.data(), length);
+        // Header last, length field last of all: a reader never sees a length before its payload
+        uint32_t finalLength = record.length;
+        record.length = 0;
+        memcpy(ring + offset, &record, sizeof(record));
+        __atomic_store_n((uint32_t*)(ring + offset), finalLength, __ATOMIC_RELEASE);
+    }
+    
+    void append(LogLevel msgLevel, string_view message) {
+        append(msgLevel, message, chrono::duration_cast<chrono::microseconds>(
+            chrono::system_clock::now().time_since_epoch()).count());
+    }
+    
+    void drainForExit() override {
+        if (mapping != nullptr) msync(mapping, mappedBytes, MS_SYNC);
+    }
+    
+    void salvageOnCrash() override {
+        // Nothing to do: the records already live in the page cache
+    }
+};
+
+// A text message waiting in the async ring. Messages longer than InlineBytes
+// are copied to a heap block that the writer thread frees once written.
+struct TextLogRecord {
+    static const size_t InlineBytes = 200;
+    
+    LogLevel level;
+    uint32_t length;
+    LogTimestamp timestamp;
+    char* spill;  // owns the text when length > InlineBytes, else nullptr
+    char text[InlineBytes];
+    
+    const char* data() const { return spill != nullptr ? spill : text; }
+};
+
+/**
+ * ASYNC LOG BACKEND
+ *
+ * Callers copy the raw message into the ring and return; the background
+ * thread formats the lines ("FILE: [timestamp] [LEVEL] message") and writes
+ * them in batches.
+ */
+class AsyncLogBackend : public RingFileWriter<TextLogRecord>, public CrashFlushTarget {
+private:
+    shared_ptr<MappedRingSink> crashMirror;
+    
+    void appendLine(LogLevel msgLevel, LogTimestamp timestamp, const char* text, size_t length) {
+        char stamp[TimestampFormatter::MaxLength];
+        batch += "FILE: [";
+        batch.append(stamp, TimestampFormatter::forThisThread().render(timestamp, stamp));
+        batch += "] [";
+        batch += logLevelName(msgLevel);
+        batch += "] ";
+        batch.append(text, length);
+        batch += '\n';
+    }
+    
+protected:
+    void appendRecord(const TextLogRecord& record) override {
+        appendLine(record.level, record.timestamp, record.data(), record.length);
+    }
+    
+    void retireRecord(const TextLogRecord& record) override {
+        delete[] record.spill;
+    }
+    
+    void appendDropNotice(uint64_t count) override {
+        string note = to_string(count) + " log messages dropped (ring full)";
+        appendLine(LogLevel::WARNING, captureTimestamp(), note.data(), note.size());
+    }
+    
+public:
+    AsyncLogBackend(const string& filename, size_t capacity = 1 << 16,
+                    OverflowPolicy policy = OverflowPolicy::Block, uint64_t sampleEvery = 10)
+        : RingFileWriter(filename, capacity, policy, sampleEvery) {
+        start();
+        CrashFlusher::add(this);
+    }
+    
+    ~AsyncLogBackend() {
+        CrashFlusher::remove(this);
+        stop();
+    }
+    
+    // On a crash, messages still waiting in the ring are copied into `mirror`
+    void mirrorOnCrash(shared_ptr<MappedRingSink> mirror) {
+        crashMirror = mirror;
+    }
+    
+    void drainForExit() override {
+        flush();
+    }
+    
+    void salvageOnCrash() override {
+        if (!crashMirror) return;
+        freezeWriter();
+        visitUnwritten([this](const TextLogRecord& record) {
+            int64_t micros;
+            if (record.timestamp.mode == TimestampMode::WallClock) {
+                micros = record.timestamp.value * 1000000;
+            } else {
+                // Monotonic stamps have no wall time; clock_gettime is async-signal-safe
+                timespec now;
+                clock_gettime(CLOCK_REALTIME, &now);
+                micros = (int64_t)now.tv_sec * 1000000 + now.tv_nsec / 1000;
+            }
+            crashMirror->append(record.level, string_view(record.data(), record.length), micros);
+        });
+    }
+    
+    // Returns false if the message was dropped by the overflow policy
+    bool push(LogLevel msgLevel, string_view message) {
+        LogTimestamp timestamp = captureTimestamp();
+        return pushRecord([&](TextLogRecord& record) {
+            record.level = msgLevel;
+            record.timestamp = timestamp;
+            record.length = (uint32_t)message.size();
+            record.spill = message.size() > TextLogRecord::InlineBytes ? new char[message.size()] : nullptr;
+            memcpy(record.spill != nullptr ? record.spill : record.text, message.data(), record.length);
+        });
+    }
+};
+
+/**
+ * BINARY LOGGING
+ *
+ * Text formatting is moved out of the process altogether: every call site
+ * registers its format string once (BLOG keeps the ID in a function-local
+ * static), and each call only copies the raw argument bytes into the ring.
+ * The writer thread emits each format definition the first time it is used,
+ * followed by compact entries; log_decoder.cpp renders the file to text or
+ * JSON offline. The wire format lives in binary_log_format.h.
+ */
+class BinaryFormatRegistry {
+private:
+    mutex registryMutex;
+    vector<pair<LogLevel, const char*>> formats;  // index is the format ID
+    
+public:
+    static BinaryFormatRegistry& getInstance() {
+        static BinaryFormatRegistry instance;
+        return instance;
+    }
+    
+    // Format strings must outlive the process's logging (string literals)
+    uint32_t registerFormat(LogLevel msgLevel, const char* format) {
+        lock_guard<mutex> lock(registryMutex);
+        formats.push_back({msgLevel, format});
+        return (uint32_t)formats.size() - 1;
+    }
+    
+    pair<LogLevel, const char*> getFormat(uint32_t formatId) {
+        lock_guard<mutex> lock(registryMutex);
+        return formats[formatId];
+    }
+};
+
+/**
+ * Cheap timestamps for the binary hot path: callers record a raw CPU tick
+ * count and the writer thread converts it to wall-clock microseconds, using
+ * an anchor (ticks, wall clock) pair and a tick rate measured once per process.
+ */
+class TickClock {
+private:
+    uint64_t anchorTicks;
+    int64_t anchorMicros;
+    double ticksPerMicro;
+    
+    static int64_t wallMicros() {
+        return chrono::duration_cast<chrono::microseconds>(chrono::system_clock::now().time_since_epoch()).count();
+    }
+    
+    static double measureTicksPerMicro() {
+        uint64_t startTicks = now();
+        auto start = chrono::steady_clock::now();
+        this_thread::sleep_for(chrono::milliseconds(10));
+        uint64_t endTicks = now();
+        double micros = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        return (endTicks - startTicks) / micros;
+    }
+    
+public:
+    TickClock() {
+        static const double measuredRate = measureTicksPerMicro();
+        ticksPerMicro = measuredRate;
+        reanchor();
+    }
+    
+    static uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#elif defined(__aarch64__)
+        uint64_t ticks;
+        asm volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+        return ticks;
+#else
+        return chrono::steady_clock::now().time_since_epoch().count();
+#endif
+    }
+    
+    // Re-reads the wall clock so conversions do not drift over long runs
+    void reanchor() {
+        anchorTicks = now();
+        anchorMicros = wallMicros();
+    }
+    
+    int64_t toWallMicros(uint64_t ticks) const {
+        return anchorMicros + (int64_t)llround(((double)ticks - (double)anchorTicks) / ticksPerMicro);
+    }
+};
+
+// A binary log entry waiting in the ring: format ID plus encoded arguments
+struct BinaryLogRecord {
+    static const size_t MaxArgBytes = 104;  // sized so a ring slot is two cache lines
+    
+    uint32_t formatId;
+    uint16_t length;
+    uint64_t ticks;  // TickClock::now() at the call
+    uint8_t args[MaxArgBytes];
+};
+
+// Encodes arguments as (type tag, raw bytes); arguments that no longer fit are left out
+class BinaryArgWriter {
+private:
+    uint8_t* out;
+    size_t capacity;
+    size_t length = 0;
+    
+    void putNumber(uint8_t tag, const void* value) {
+        if (length + 1 + 8 > capacity) return;
+        out[length] = tag;
+        memcpy(out + length + 1, value, 8);
+        length += 9;
+    }
+    
+    void putString(string_view value) {
+        if (length + 3 > capacity) return;
+        uint16_t count = (uint16_t)min(value.size(), capacity - length - 3);
+        out[length] = BinaryArgString;
+        memcpy(out + length + 1, &count, 2);
+        memcpy(out + length + 3, value.data(), count);
+        length += 3 + count;
+    }
+    
+public:
+    BinaryArgWriter(uint8_t* out, size_t capacity) : out(out), capacity(capacity) {}
+    
+    template <typename T>
+    void add(const T& value) {
+        if constexpr (is_same_v<T, bool> || (is_integral_v<T> && is_signed_v<T>)) {
+            int64_t number = (int64_t)value;
+            putNumber(BinaryArgSigned, &number);
+        } else if constexpr (is_integral_v<T>) {
+            uint64_t number = (uint64_t)value;
+            putNumber(BinaryArgUnsigned, &number);
+        } else if constexpr (is_floating_point_v<T>) {
+            double number = (double)value;
+            putNumber(BinaryArgDouble, &number);
+        } else {
+            putString(string_view(value));
+        }
+    }
+    
+    size_t size() const { return length; }
+};
+
+class BinaryLogBackend : public RingFileWriter<BinaryLogRecord> {
+private:
+    LogLevel minLevel;
+    vector<bool> formatWritten;  // consumer only
+    TickClock clock;             // consumer only (besides TickClock::now)
+    uint64_t lastAnchorTicks;    // consumer only
+    
+    template <typename T>
+    void appendValue(const T& value) {
+        batch.append((const char*)&value, sizeof(value));
+    }
+    
+protected:
+    void appendRecord(const BinaryLogRecord& record) override {
+        // Signed: records queued before the last reanchor are stamped
+        // earlier than lastAnchorTicks and must not look 2^64 ticks late
+        if ((int64_t)(record.ticks - lastAnchorTicks) > (int64_t)1 << 32) {
+            clock.reanchor();
+            lastAnchorTicks = TickClock::now();
+        }
+        if (record.formatId >= formatWritten.size()) {
+            formatWritten.resize(record.formatId + 1, false);
+        }
+        if (!formatWritten[record.formatId]) {
+            auto format = BinaryFormatRegistry::getInstance().getFormat(record.formatId);
+            uint16_t formatLength = (uint16_t)strlen(format.second);
+            appendValue((uint8_t)BinaryRecordFormat);
+            appendValue(record.formatId);
+            appendValue((uint8_t)format.first);
+            appendValue(formatLength);
+            batch.append(format.second, formatLength);
+            formatWritten[record.formatId] = true;
+        }
+        // Entry header and arguments are assembled on the stack and appended in one go
+        char entry[1 + 4 + 8 + 2 + BinaryLogRecord::MaxArgBytes];
+        int64_t micros = clock.toWallMicros(record.ticks);
+        entry[0] = (char)BinaryRecordEntry;
+        memcpy(entry + 1, &record.formatId, 4);
+        memcpy(entry + 5, &micros, 8);
+        memcpy(entry + 13, &record.length, 2);
+        memcpy(entry + 15, record.args, record.length);
+        batch.append(entry, 15 + record.length);
+    }
+    
+    void appendDropNotice(uint64_t count) override {
+        appendValue((uint8_t)BinaryRecordDrops);
+        appendValue(clock.toWallMicros(TickClock::now()));
+        appendValue(count);
+    }
+    
+public:
+    BinaryLogBackend(const string& filename, LogLevel minLevel = LogLevel::INFO, size_t capacity = 1 << 16,
+                     OverflowPolicy policy = OverflowPolicy::Block, uint64_t sampleEvery = 10)
+        : RingFileWriter(filename, capacity, policy, sampleEvery), minLevel(minLevel), lastAnchorTicks(TickClock::now()) {
+        if (fd >= 0 && lseek(fd, 0, SEEK_END) == 0) {
+            batch.assign(BinaryLogMagic, sizeof(BinaryLogMagic));
+        }
+        start();
+    }
+    
+    ~BinaryLogBackend() {
+        stop();
+    }
+    
+    bool isEnabled(LogLevel msgLevel) const { return msgLevel >= minLevel; }
+    
+    // Returns false if the entry was dropped by the overflow policy
+    template <typename... Args>
+    bool log(uint32_t formatId, const Args&... args) {
+        uint64_t ticks = TickClock::now();
+        return pushRecord([&](BinaryLogRecord& record) {
+            record.formatId = formatId;
+            record.ticks = ticks;
+            BinaryArgWriter writer(record.args, BinaryLogRecord::MaxArgBytes);
+            (writer.add(args), ...);
+            record.length = (uint16_t)writer.size();
+        });
+    }
+};
+
+// BLOG(backend, level, "order {} took {} ms", id, millis): "{}" marks each argument
+#define BLOG(backend, msgLevel, format, ...)                                                           \
+    do {                                                                                               \
+        if ((backend).isEnabled(msgLevel)) {                                                           \
+            static const uint32_t formatId_ = BinaryFormatRegistry::getInstance().registerFormat(msgLevel, format); \
+            (backend).log(formatId_, ##__VA_ARGS__);                                                   \
+        }                                                                                              \
+    } while (0)
+
+// Concrete Logger 5: Async File Logger (hands messages to an AsyncLogBackend)
+class AsyncFileLogger : public Logger {
+private:
+    shared_ptr<AsyncLogBackend> backend;
+    
+public:
+    AsyncFileLogger(LogLevel level, shared_ptr<AsyncLogBackend> backend) : Logger(level), backend(backend) {}
+    
+protected:
+    void write(const string& message) override {
+        backend->push(level, message);
+    }
+    
+    void writeMessage(LogLevel msgLevel, const string& message) override {
+        backend->push(msgLevel, message);
+    }
+};
+
+/**
+ * PER-THREAD BUFFERS WITH ORDERED MERGE
+ *
+ * Instead of every thread contending on one stream, each producer thread
+ * appends to its own single-producer ring (registered with the collector on
+ * first use). Records carry a global sequence number taken just before they
+ * are published, and the collector thread merges the heads of all rings by
+ * sequence, emitting strictly consecutive numbers: if the next number is
+ * still being written by some thread it waits for it, so the output has one
+ * global order that matches the order of the calls.
+ */
+class MergingLogCollector : public CrashFlushTarget {
+private:
+    // Longer messages spill to a heap block the collector frees once written
+    struct MergeRecord {
+        static const size_t InlineBytes = 200;
+        
+        uint64_t sequence;
+        LogLevel level;
+        uint32_t length;
+        LogTimestamp timestamp;
+        char* spill;  // owns the text when length > InlineBytes, else nullptr
+        char text[InlineBytes];
+        
+        const char* data() const { return spill != nullptr ? spill : text; }
+    };
+    
+    // Single-producer / single-consumer ring owned by one producer thread
+    struct ThreadBuffer {
+        static const size_t Capacity = 1024;
+        
+        unique_ptr<MergeRecord[]> records{new MergeRecord[Capacity]};  // freed when the collector closes
+        alignas(64) atomic<uint64_t> head{0};  // next slot the collector reads
+        alignas(64) atomic<uint64_t> tail{0};  // next slot the producer writes
+        atomic<bool> retired{false};           // owning thread has exited
+        atomic<bool> closed{false};            // collector is gone; the owner drops its entry
+    };
+    
+    // The calling thread's buffers, one per collector it has logged to. Entries
+    // of closed collectors are pruned the next time the thread logs anywhere.
+    struct ThreadBuffers {
+        vector<pair<uint64_t, shared_ptr<ThreadBuffer>>> entries;
+        
+        ~ThreadBuffers() {
+            for (auto& entry : entries) {
+                entry.second->retired.store(true, memory_order_release);
+            }
+        }
+    };
+    
+    const uint64_t collectorId;
+    int fd;
+    string linePrefix;
+    alignas(64) atomic<uint64_t> nextSequence{0};
+    alignas(64) atomic<uint64_t> emitted{0};
+    atomic<bool> running{true};
+    
+    mutex registrationMutex;
+    vector<shared_ptr<ThreadBuffer>> newBuffers;  // guarded by registrationMutex
+    vector<shared_ptr<ThreadBuffer>> buffers;     // collector only
+    string batch;                                 // collector only
+    thread collector;
+    
+    static uint64_t nextCollectorId() {
+        static atomic<uint64_t> ids{1};
+        return ids.fetch_add(1, memory_order_relaxed);
+    }
+    
+    ThreadBuffer& bufferForThisThread() {
+        thread_local ThreadBuffers mine;
+        mine.entries.erase(remove_if(mine.entries.begin(), mine.entries.end(), [](const auto& entry) {
+            return entry.second->closed.load(memory_order_acquire);
+        }), mine.entries.end());
+        for (auto& entry : mine.entries) {
+            if (entry.first == collectorId) return *entry.second;
+        }
+        auto buffer = make_shared<ThreadBuffer>();
+        {
+            lock_guard<mutex> lock(registrationMutex);
+            newBuffers.push_back(buffer);
+        }
+        mine.entries.push_back({collectorId, buffer});
+        return *buffer;
+    }
+    
+    void appendLine(const MergeRecord& record) {
+        char stamp[TimestampFormatter::MaxLength];
+        batch += linePrefix;
+        batch += '[';
+        batch.append(stamp, TimestampFormatter::forThisThread().render(record.timestamp, stamp));
+        batch += "] [";
+        batch += logLevelName(record.level);
+        batch += "] ";
+        batch.append(record.data(), record.length);
+        batch += '\n';
+        delete[] record.spill;
+    }
+    
+    void writeBatch() {
+        const char* data = batch.data();
+        size_t remaining = batch.size();
+        while (remaining > 0 && fd >= 0) {
+            ssize_t count = ::write(fd, data, remaining);
+            if (count <= 0) break;
+            data += count;
+            remaining -= count;
+        }
+        batch.clear();
+    }
+    
+    // One k-way merge pass over the ring heads; returns records emitted
+    size_t mergeOnce() {
+        {
+            lock_guard<mutex> lock(registrationMutex);
+            buffers.insert(buffers.end(), newBuffers.begin(), newBuffers.end());
+            newBuffers.clear();
+        }
+        
+        using Head = pair<uint64_t, ThreadBuffer*>;  // (sequence at the head, buffer)
+        priority_queue<Head, vector<Head>, greater<Head>> heads;
+        auto pushHead = [&heads](ThreadBuffer* buffer) {
+            uint64_t position = buffer->head.load(memory_order_relaxed);
+            if (position != buffer->tail.load(memory_order_acquire)) {
+                heads.push({buffer->records[position % ThreadBuffer::Capacity].sequence, buffer});
+            }
+        };
+        for (auto& buffer : buffers) {
+            pushHead(buffer.get());
+        }
+        
+        uint64_t expected = emitted.load(memory_order_relaxed);
+        size_t count = 0;
+        while (!heads.empty() && heads.top().first == expected) {
+            ThreadBuffer* buffer = heads.top().second;
+            heads.pop();
+            uint64_t position = buffer->head.load(memory_order_relaxed);
+            appendLine(buffer->records[position % ThreadBuffer::Capacity]);
+            buffer->head.store(position + 1, memory_order_release);
+            pushHead(buffer);
+            expected++;
+            count++;
+            if (batch.size() >= 64 * 1024) {
+                writeBatch();
+            }
+        }
+        if (!batch.empty()) {
+            writeBatch();
+        }
+        emitted.store(expected, memory_order_release);
+        
+        // Forget buffers whose thread has exited and that have been fully drained
+        buffers.erase(remove_if(buffers.begin(), buffers.end(), [](const shared_ptr<ThreadBuffer>& buffer) {
+            return buffer->retired.load(memory_order_acquire) &&
+                   buffer->head.load(memory_order_relaxed) == buffer->tail.load(memory_order_acquire);
+        }), buffers.end());
+        return count;
+    }
+    
+    void collectorLoop() {
+        while (running.load(memory_order_acquire)) {
+            if (mergeOnce() == 0) {
+                this_thread::sleep_for(chrono::microseconds(200));
+            }
+        }
+        while (emitted.load(memory_order_relaxed) < nextSequence.load(memory_order_acquire)) {
+            if (mergeOnce() == 0) this_thread::yield();
+        }
+    }
+    
+public:
+    // Merged lines go to `filename`, each prefixed with linePrefix
+    MergingLogCollector(const string& filename, const string& linePrefix = "FILE: ")
+        : collectorId(nextCollectorId()), linePrefix(linePrefix) {
+        fd = open(filename.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (fd < 0) {
+            cerr << "Error: Could not open file " << filename << endl;
+        }
+        collector = thread(&MergingLogCollector::collectorLoop, this);
+        CrashFlusher::add(this);
+    }
     
-    // Set the next logger in chain
-    void setNextLogger(shared_ptr<Logger> nextLogger) {
-        nextLoggerInChain = nextLogger;
+    // Every record has been written by now, so the rings' storage is freed
+    // here rather than when each producer thread exits
+    ~MergingLogCollector() {
+        CrashFlusher::remove(this);
+        running.store(false, memory_order_release);
+        collector.join();
+        if (fd >= 0) close(fd);
+        lock_guard<mutex> lock(registrationMutex);
+        buffers.insert(buffers.end(), newBuffers.begin(), newBuffers.end());
+        for (auto& buffer : buffers) {
+            buffer->records.reset();
+            buffer->closed.store(true, memory_order_release);
+        }
     }
     
-    // Main method that implements Chain of Responsibility
-    void logMessage(LogLevel msgLevel, const string& message) {
-        // If current logger can handle this level, process it
-        if (msgLevel >= level) {
-            write(message);
+    // Waits for room in this thread's buffer rather than dropping: a taken
+    // sequence number must always be published or the merge would stall
+    void append(LogLevel msgLevel, string_view message) {
+        ThreadBuffer& buffer = bufferForThisThread();
+        uint64_t position = buffer.tail.load(memory_order_relaxed);
+        while (position - buffer.head.load(memory_order_acquire) >= ThreadBuffer::Capacity) {
+            this_thread::yield();
         }
-        
-        // Always pass to next logger in chain (if exists)
-        if (nextLoggerInChain != nullptr) {
-            nextLoggerInChain->logMessage(msgLevel, message);
+        MergeRecord& record = buffer.records[position % ThreadBuffer::Capacity];
+        record.level = msgLevel;
+        record.timestamp = captureTimestamp();
+        record.length = (uint32_t)message.size();
+        record.spill = message.size() > MergeRecord::InlineBytes ? new char[message.size()] : nullptr;
+        memcpy(record.spill != nullptr ? record.spill : record.text, message.data(), record.length);
+        record.sequence = nextSequence.fetch_add(1, memory_order_relaxed);
+        buffer.tail.store(position + 1, memory_order_release);
+    }
+    
+    // Blocks until everything appended so far has been written
+    void flush() {
+        uint64_t target = nextSequence.load(memory_order_acquire);
+        while (emitted.load(memory_order_acquire) < target) {
+            this_thread::sleep_for(chrono::microseconds(100));
         }
     }
     
-protected:
-    // Pure virtual method - each concrete logger implements its own way
-    virtual void write(const string& message) = 0;
+    void drainForExit() override {
+        flush();
+    }
     
-    // Helper method to format log message
-    virtual string formatMessage(const string& message, LogLevel msgLevel) {
-        return "[" + getCurrentTimestamp() + "] [" + 
-               logLevelToString(msgLevel) + "] " + message;
+    void salvageOnCrash() override {
+        // Nothing safe to do: merging and formatting need the collector thread
     }
 };
 
-// Concrete Logger 1: Console Logger
-class ConsoleLogger : public Logger {
+// Concrete Logger 6: Merged Logger (per-thread buffers, one ordered output)
+class MergedLogger : public Logger {
+private:
+    shared_ptr<MergingLogCollector> collector;
+    
 public:
-    ConsoleLogger(LogLevel level) : Logger(level) {}
+    MergedLogger(LogLevel level, shared_ptr<MergingLogCollector> collector) : Logger(level), collector(collector) {}
     
 protected:
     void write(const string& message) override {
-        cout << "CONSOLE: " << formatMessage(message, level) << endl;
+        collector->append(level, message);
+    }
+    
+    void writeMessage(LogLevel msgLevel, const string& message) override {
+        collector->append(msgLevel, message);
     }
 };
 
-// Concrete Logger 2: File Logger
-class FileLogger : public Logger {
+// Concrete Logger 7: Crash-Safe Logger (records land in a memory-mapped ring)
+class MappedRingLogger : public Logger {
 private:
-    string filename;
+    shared_ptr<MappedRingSink> sink;
     
 public:
-    FileLogger(LogLevel level, const string& file) : Logger(level), filename(file) {}
+    MappedRingLogger(LogLevel level, shared_ptr<MappedRingSink> sink) : Logger(level), sink(sink) {}
     
 protected:
     void write(const string& message) override {
-        ofstream file(filename, ios::app);  // Append mode
-        if (file.is_open()) {
-            file << "FILE: " << formatMessage(message, level) << endl;
-            file.close();
-            cout << "Message logged to file: " << filename << endl;
-        } else {
-            cerr << "Error: Could not open file " << filename << endl;
-        }
+        sink->append(level, message);
     }
-};
-
-// Concrete Logger 3: Error Logger (for critical errors)
-class ErrorLogger : public Logger {
-public:
-    ErrorLogger(LogLevel level) : Logger(level) {}
     
-protected:
-    void write(const string& message) override {
-        cerr << "ERROR LOG: " << formatMessage(message, level) << endl;
-        // Could also send email, SMS, or other critical notifications
-        cout << "*** CRITICAL ERROR ALERT SENT ***" << endl;
+    void writeMessage(LogLevel msgLevel, const string& message) override {
+        sink->append(msgLevel, message);
     }
 };
 
-// Concrete Logger 4: Debug Logger (detailed debugging info)
-class DebugLogger : public Logger {
+// Number of slots needed to index anything by LogLevel
+const int LogLevelSlots = (int)LogLevel::FATAL + 1;
+
+/**
+ * LEVEL DISPATCH TABLE
+ *
+ * Flattens a chain into the list of handlers that accept each level, so a
+ * message goes straight to its handlers (in chain order) instead of asking
+ * every link. Built once per chain configuration.
+ */
+class LevelDispatchTable {
+private:
+    shared_ptr<Logger> chain;  // keeps the handlers alive
+    array<vector<Logger*>, LogLevelSlots> handlersByLevel;
+    uint32_t enabledMask = 0;
+    
 public:
-    DebugLogger(LogLevel level) : Logger(level) {}
+    explicit LevelDispatchTable(shared_ptr<Logger> head) : chain(head) {
+        for (int lvl = (int)LogLevel::INFO; lvl <= (int)LogLevel::FATAL; lvl++) {
+            for (Logger* logger = chain.get(); logger != nullptr; logger = logger->getNextLogger()) {
+                if (logger->accepts((LogLevel)lvl)) {
+                    handlersByLevel[lvl].push_back(logger);
+                }
+            }
+            if (!handlersByLevel[lvl].empty()) {
+                enabledMask |= 1u << lvl;
+            }
+        }
+    }
     
-protected:
-    void write(const string& message) override {
-        cout << "DEBUG: " << formatMessage(message, level) << " [PID: " << 
-               getpid() << "]" << endl;
+    // Bit i is set when some handler accepts LogLevel i
+    uint32_t getEnabledMask() const { return enabledMask; }
+    
+    void dispatch(LogLevel msgLevel, const string& message) const {
+        for (Logger* logger : handlersByLevel[(int)msgLevel]) {
+            logger->handle(msgLevel, message);
+        }
     }
     
-private:
-    int getpid() {
-        // Simulate process ID
-        return 12345;
+    // Like dispatch, but a level no handler accepts goes to the handlers of the
+    // lowest enabled level instead (a module raised above the chain's levels)
+    void dispatchOverride(LogLevel msgLevel, const string& message) const {
+        if (handlersByLevel[(int)msgLevel].empty() && enabledMask != 0) {
+            int lowest = __builtin_ctz(enabledMask);
+            for (Logger* logger : handlersByLevel[lowest]) {
+                logger->handle(msgLevel, message);
+            }
+            return;
+        }
+        dispatch(msgLevel, message);
     }
 };
 
+// Handle for a named subsystem with its own runtime log level (LoggerManager::getModule)
+struct LogModule {
+    uint32_t id = 0;
+};
+
 // Logger Builder/Factory to create the chain
 class LoggerChainBuilder {
 public:
@@ -182,54 +2012,290 @@ public:
         fileLogger->setNextLogger(errorLogger);
         return fileLogger;
     }
+    
+    // Production chain whose file output is merged from per-thread buffers
+    static shared_ptr<Logger> createMergedProductionLoggerChain(shared_ptr<MergingLogCollector> collector) {
+        auto fileLogger = make_shared<MergedLogger>(LogLevel::WARNING, collector);
+        auto errorLogger = make_shared<ErrorLogger>(LogLevel::ERROR);
+        
+        fileLogger->setNextLogger(errorLogger);
+        return fileLogger;
+    }
+    
+    // Production chain that survives crashes: every WARNING and above is in the
+    // mapped ring before the call returns
+    static shared_ptr<Logger> createCrashSafeProductionLoggerChain(shared_ptr<MappedRingSink> crashRing) {
+        auto ringLogger = make_shared<MappedRingLogger>(LogLevel::WARNING, crashRing);
+        auto errorLogger = make_shared<ErrorLogger>(LogLevel::ERROR);
+        
+        ringLogger->setNextLogger(errorLogger);
+        return ringLogger;
+    }
+    
+    // Production chain with the file write moved off the caller's thread
+    static shared_ptr<Logger> createAsyncProductionLoggerChain(shared_ptr<AsyncLogBackend> backend) {
+        auto fileLogger = make_shared<AsyncFileLogger>(LogLevel::WARNING, backend);
+        auto errorLogger = make_shared<ErrorLogger>(LogLevel::ERROR);
+        
+        fileLogger->setNextLogger(errorLogger);
+        return fileLogger;
+    }
 };
 
 // Enhanced Logger Manager (Singleton pattern)
+//
+// Log calls never lock: every thread keeps its own reference to the dispatch
+// table it last used and only re-reads the published one (under chainMutex)
+// after a swap bumps chainVersion. A replaced chain is freed once the last
+// thread holding it has moved on. Levels no handler accepts are rejected by a
+// single test against enabledLevels before any of that happens.
+//
+// Modules (tags) get their own level and sampling, changeable at runtime:
+// each module's state is one atomic word checked with a relaxed load, so a
+// filtered module message costs about as much as a filtered global one.
 class LoggerManager {
 private:
-    shared_ptr<Logger> loggerChain;
-    static LoggerManager* instance;
+    // Per-module state word: enabled levels, sampled levels, inherit flag
+    static const uint32_t ModuleMaskBits = 0xFFu;
+    static const int ModuleSampledShift = 8;
+    static const uint32_t ModuleInheritsChain = 1u << 16;
+    static const int MaxModules = 64;
+    
+    struct ModuleState {
+        atomic<uint32_t> state{ModuleInheritsChain};
+        array<atomic<uint32_t>, LogLevelSlots> sampleThreshold{};  // keep if random32 < threshold
+        string name;  // fixed once registered
+    };
+    
+    array<ModuleState, MaxModules> modules;
+    atomic<uint32_t> moduleCount{1};  // module 0 is the untagged default
+    mutex moduleMutex;
+    
+    static uint32_t threadRandom() {
+        thread_local uint64_t state = 0x9E3779B97F4A7C15ull ^ (uint64_t)(uintptr_t)&state;
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return (uint32_t)(state >> 32);
+    }
+    
+    struct CachedTable {
+        uint64_t version = 0;
+        shared_ptr<const LevelDispatchTable> table;
+    };
+    
+    shared_ptr<const LevelDispatchTable> dispatchTable;  // guarded by chainMutex
+    mutex chainMutex;
+    atomic<uint64_t> chainVersion{1};
+    atomic<uint32_t> enabledLevels{0};
     
     LoggerManager() {
-        loggerChain = LoggerChainBuilder::createLoggerChain();
+        publishChain(LoggerChainBuilder::createLoggerChain());
+    }
+    
+    const LevelDispatchTable* currentTable() {
+        thread_local CachedTable cached;
+        if (cached.version != chainVersion.load(memory_order_acquire)) {
+            lock_guard<mutex> lock(chainMutex);
+            cached.table = dispatchTable;
+            cached.version = chainVersion.load(memory_order_relaxed);
+        }
+        return cached.table.get();
+    }
+    
+    void writeModuleMessage(LogModule module, LogLevel msgLevel, const string& message) {
+        if (module.id == 0) {
+            currentTable()->dispatchOverride(msgLevel, message);
+            return;
+        }
+        currentTable()->dispatchOverride(msgLevel, "[" + modules[module.id].name + "] " + message);
+    }
+    
+    void publishChain(shared_ptr<Logger> chain) {
+        auto table = make_shared<const LevelDispatchTable>(chain);
+        lock_guard<mutex> lock(chainMutex);
+        enabledLevels.store(table->getEnabledMask(), memory_order_relaxed);
+        dispatchTable = move(table);
+        chainVersion.fetch_add(1, memory_order_release);
     }
     
 public:
+    LoggerManager(const LoggerManager&) = delete;
+    LoggerManager& operator=(const LoggerManager&) = delete;
+    
     static LoggerManager* getInstance() {
-        if (instance == nullptr) {
-            instance = new LoggerManager();
+        static LoggerManager instance;  // initialised exactly once, even with concurrent callers
+        return &instance;
+    }
+    
+    bool isEnabled(LogLevel msgLevel) const {
+        return (enabledLevels.load(memory_order_relaxed) >> (int)msgLevel) & 1u;
+    }
+    
+    void logMessage(LogLevel msgLevel, const string& message) {
+        if (isEnabled(msgLevel)) {
+            currentTable()->dispatch(msgLevel, message);
         }
-        return instance;
+    }
+    
+    // Finds or registers the module called `name`; up to MaxModules - 1 names,
+    // after which the default module is returned
+    LogModule getModule(const string& name) {
+        lock_guard<mutex> lock(moduleMutex);
+        uint32_t count = moduleCount.load(memory_order_relaxed);
+        for (uint32_t id = 1; id < count; id++) {
+            if (modules[id].name == name) return LogModule{id};
+        }
+        if (count == MaxModules) {
+            cerr << "Warning: too many log modules; " << name << " uses the default levels" << endl;
+            return LogModule{0};
+        }
+        modules[count].name = name;
+        moduleCount.store(count + 1, memory_order_release);
+        return LogModule{count};
+    }
+    
+    // Module messages at or above `minLevel` are logged even when the chain's
+    // handlers would not accept them; below it they are dropped
+    void setModuleLevel(LogModule module, LogLevel minLevel) {
+        uint32_t mask = 0;
+        for (int lvl = (int)minLevel; lvl <= (int)LogLevel::FATAL; lvl++) mask |= 1u << lvl;
+        uint32_t current = modules[module.id].state.load(memory_order_relaxed);
+        while (!modules[module.id].state.compare_exchange_weak(
+            current, (current & ~(ModuleMaskBits | ModuleInheritsChain)) | mask, memory_order_relaxed)) {}
+    }
+    
+    // Back to whatever the chain accepts
+    void resetModuleLevel(LogModule module) {
+        modules[module.id].state.fetch_or(ModuleInheritsChain, memory_order_relaxed);
+    }
+    
+    // Keeps a `keepFraction` share of the module's messages at `msgLevel`
+    // (meant for high-volume INFO/DEBUG); 1.0 turns sampling off
+    void setModuleSampling(LogModule module, LogLevel msgLevel, double keepFraction) {
+        ModuleState& target = modules[module.id];
+        uint32_t bit = 1u << (ModuleSampledShift + (int)msgLevel);
+        if (keepFraction >= 1.0) {
+            target.state.fetch_and(~bit, memory_order_relaxed);
+            return;
+        }
+        target.sampleThreshold[(int)msgLevel].store(
+            (uint32_t)(max(keepFraction, 0.0) * 4294967296.0), memory_order_relaxed);
+        target.state.fetch_or(bit, memory_order_relaxed);
+    }
+    
+    // The module-aware level check: one relaxed load, plus a random draw for sampled levels
+    bool isEnabled(LogModule module, LogLevel msgLevel) const {
+        const ModuleState& target = modules[module.id];
+        uint32_t state = target.state.load(memory_order_relaxed);
+        uint32_t mask = (state & ModuleInheritsChain) ? enabledLevels.load(memory_order_relaxed) : state;
+        if (!((mask >> (int)msgLevel) & 1u)) return false;
+        if (!((state >> (ModuleSampledShift + (int)msgLevel)) & 1u)) return true;
+        return threadRandom() < target.sampleThreshold[(int)msgLevel].load(memory_order_relaxed);
+    }
+    
+    void logMessage(LogModule module, LogLevel msgLevel, const string& message) {
+        if (isEnabled(module, msgLevel)) {
+            writeModuleMessage(module, msgLevel, message);
+        }
+    }
+    
+    // Streams the arguments into a message once the module check has passed;
+    // the caller (LOG_MODULE) has already done that check and the sampling draw
+    template <typename... Args>
+    void logUnchecked(LogModule module, LogLevel msgLevel, const Args&... args) {
+        ostringstream message;
+        (message << ... << args);
+        writeModuleMessage(module, msgLevel, message.str());
+    }
+    
+    // Streams the arguments into a message only when the level is enabled
+    template <typename... Args>
+    void log(LogLevel msgLevel, const Args&... args) {
+        if (!isEnabled(msgLevel)) return;
+        ostringstream message;
+        (message << ... << args);
+        currentTable()->dispatch(msgLevel, message.str());
     }
     
     void info(const string& message) {
-        loggerChain->logMessage(LogLevel::INFO, message);
+        logMessage(LogLevel::INFO, message);
     }
     
     void debug(const string& message) {
-        loggerChain->logMessage(LogLevel::DEBUG, message);
+        logMessage(LogLevel::DEBUG, message);
     }
     
     void warning(const string& message) {
-        loggerChain->logMessage(LogLevel::WARNING, message);
+        logMessage(LogLevel::WARNING, message);
     }
     
     void error(const string& message) {
-        loggerChain->logMessage(LogLevel::ERROR, message);
+        logMessage(LogLevel::ERROR, message);
     }
     
     void fatal(const string& message) {
-        loggerChain->logMessage(LogLevel::FATAL, message);
+        logMessage(LogLevel::FATAL, message);
+    }
+    
+    // Methods to switch to different chain configurations; safe while other threads log
+    void useDefaultChain() {
+        publishChain(LoggerChainBuilder::createLoggerChain());
     }
     
-    // Method to switch to different chain configurations
     void useProductionChain() {
-        loggerChain = LoggerChainBuilder::createProductionLoggerChain();
+        publishChain(LoggerChainBuilder::createProductionLoggerChain());
+    }
+    
+    void useAsyncProductionChain(shared_ptr<AsyncLogBackend> backend) {
+        publishChain(LoggerChainBuilder::createAsyncProductionLoggerChain(backend));
+    }
+    
+    void useMergedProductionChain(shared_ptr<MergingLogCollector> collector) {
+        publishChain(LoggerChainBuilder::createMergedProductionLoggerChain(collector));
+    }
+    
+    void useCrashSafeProductionChain(shared_ptr<MappedRingSink> crashRing) {
+        publishChain(LoggerChainBuilder::createCrashSafeProductionLoggerChain(crashRing));
+    }
+    
+    // Logs the message as FATAL, drains every registered sink synchronously
+    // (async rings written out, mapped rings synced to disk), then aborts
+    [[noreturn]] void fatalAndAbort(const string& message) {
+        fatal(message);
+        CrashFlusher::drainAll();
+        abort();
     }
 };
 
-// Static member definition
-LoggerManager* LoggerManager::instance = nullptr;
+// Logging macros: the arguments are not even evaluated when the level is
+// filtered out, and LOG_DEBUG compiles to nothing in release (NDEBUG) builds.
+#define LOG_AT(msgLevel, ...)                                             \
+    do {                                                                  \
+        LoggerManager* logManager_ = LoggerManager::getInstance();        \
+        if (logManager_->isEnabled(msgLevel)) {                           \
+            logManager_->log(msgLevel, __VA_ARGS__);                      \
+        }                                                                 \
+    } while (0)
+
+// Same for a module: its own level and sampling decide, not the chain's
+#define LOG_MODULE(module, msgLevel, ...)                                 \
+    do {                                                                  \
+        LoggerManager* logManager_ = LoggerManager::getInstance();        \
+        if (logManager_->isEnabled(module, msgLevel)) {                   \
+            logManager_->logUnchecked(module, msgLevel, __VA_ARGS__);     \
+        }                                                                 \
+    } while (0)
+
+#define LOG_INFO(...) LOG_AT(LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNING(...) LOG_AT(LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERROR(...) LOG_AT(LogLevel::ERROR, __VA_ARGS__)
+#define LOG_FATAL(...) LOG_AT(LogLevel::FATAL, __VA_ARGS__)
+#ifdef NDEBUG
+#define LOG_DEBUG(...) ((void)0)
+#else
+#define LOG_DEBUG(...) LOG_AT(LogLevel::DEBUG, __VA_ARGS__)
+#endif
 
 // Demo Application
 class Application {
@@ -257,10 +2323,671 @@ public:
         logger->useProductionChain();
         logger->info("This info message won't appear in production mode");
         logger->error("This error will still be logged in production");
+        
+        cout << "\n=== Switching to Async Production Mode ===" << endl;
+        auto backend = make_shared<AsyncLogBackend>("production.log");
+        logger->useAsyncProductionChain(backend);
+        logger->warning("Disk usage at 85% (written by the background thread)");
+        backend->flush();
+        
+        cout << "\n=== Binary Logging Mode ===" << endl;
+        {
+            BinaryLogBackend binaryLog("app.binlog");
+            BLOG(binaryLog, LogLevel::INFO, "user {} logged in from {}", 1042, "10.0.0.7");
+            BLOG(binaryLog, LogLevel::WARNING, "cache hit ratio dropped to {}", 0.62);
+        }
+        cout << "Binary entries written to app.binlog (render with: log_decoder [--json] app.binlog)" << endl;
     }
 };
 
-int main() {
+// Caller-side cost of AsyncLogBackend::push: bursts that fit in the ring show
+// the uncontended latency, then four producers overload it under each policy
+void benchmarkAsyncBackend() {
+    const string message = "order 42 processed in 17 ms by worker-7";
+    
+    cout << "\n=== Async backend benchmark ===" << endl;
+    {
+        auto backend = make_shared<AsyncLogBackend>("bench_async.log", 1 << 14);
+        const int bursts = 50, burstSize = 8192;
+        double totalNanos = 0;
+        for (int b = 0; b < bursts; b++) {
+            auto begin = chrono::steady_clock::now();
+            for (int i = 0; i < burstSize; i++) {
+                backend->push(LogLevel::WARNING, message);
+            }
+            totalNanos += chrono::duration<double, nano>(chrono::steady_clock::now() - begin).count();
+            backend->flush();
+        }
+        cout << "burst (ring not full): " << totalNanos / (bursts * burstSize) << " ns/call on the caller" << endl;
+    }
+    
+    const OverflowPolicy policies[] = {OverflowPolicy::Block, OverflowPolicy::Drop, OverflowPolicy::Sample};
+    const char* names[] = {"block", "drop", "sample"};
+    const int producers = 4, perProducer = 250000;
+    for (int p = 0; p < 3; p++) {
+        auto backend = make_shared<AsyncLogBackend>("bench_async.log", 1 << 14, policies[p], 10);
+        vector<thread> threads;
+        auto start = chrono::steady_clock::now();
+        for (int t = 0; t < producers; t++) {
+            threads.emplace_back([&]() {
+                for (int i = 0; i < perProducer; i++) {
+                    backend->push(LogLevel::WARNING, message);
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        double callerMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        backend->flush();
+        double wallMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        cout << "overload/" << names[p] << ": " << callerMs * 1e6 / (producers * perProducer)
+             << " ns/call, " << backend->getDroppedCount() << " of " << producers * perProducer
+             << " dropped, " << wallMs << " ms until written" << endl;
+    }
+    remove("bench_async.log");
+    
+    // Messages longer than a ring slot arrive whole
+    const string longMessage(5000, 'x');
+    {
+        AsyncLogBackend backend("bench_async.log");
+        backend.push(LogLevel::WARNING, message);
+        backend.push(LogLevel::WARNING, longMessage);
+        backend.flush();
+    }
+    ifstream in("bench_async.log");
+    string line, lastLine;
+    while (getline(in, line)) lastLine = line;
+    in.close();
+    remove("bench_async.log");
+    bool whole = lastLine.size() > longMessage.size() &&
+                 lastLine.compare(lastLine.size() - longMessage.size(), string::npos, longMessage) == 0;
+    cout << "5000-byte message: " << (whole ? "written whole" : "TRUNCATED") << endl;
+}
+
+// 32 threads log WARNINGs while another thread keeps swapping the manager
+// between two async chains; every message must land in exactly one file
+void stressChainSwap() {
+    cout << "\n=== Chain swap stress (32 logging threads) ===" << endl;
+    LoggerManager* logger = LoggerManager::getInstance();
+    const int threadsCount = 32, perThread = 20000;
+    int swaps = 0;
+    {
+        auto backendA = make_shared<AsyncLogBackend>("stress_a.log");
+        auto backendB = make_shared<AsyncLogBackend>("stress_b.log");
+        logger->useAsyncProductionChain(backendA);
+        
+        atomic<int> finished{0};
+        vector<thread> threads;
+        for (int t = 0; t < threadsCount; t++) {
+            threads.emplace_back([&, t]() {
+                string message = "worker " + to_string(t) + " heartbeat";
+                for (int i = 0; i < perThread; i++) {
+                    logger->warning(message);
+                }
+                finished++;
+            });
+        }
+        while (finished.load() < threadsCount) {
+            logger->useAsyncProductionChain(swaps % 2 == 0 ? backendB : backendA);
+            swaps++;
+            this_thread::sleep_for(chrono::microseconds(200));
+        }
+        for (auto& t : threads) t.join();
+        logger->useProductionChain();
+        backendA->flush();
+        backendB->flush();
+    }
+    
+    long lines = 0;
+    for (const char* name : {"stress_a.log", "stress_b.log"}) {
+        ifstream in(name);
+        string line;
+        while (getline(in, line)) lines++;
+        remove(name);
+    }
+    cout << swaps << " swaps, " << lines << " of " << threadsCount * perThread << " messages written: "
+         << (lines == threadsCount * perThread ? "OK" : "MISMATCH") << endl;
+}
+
+// Cost of a call whose level no handler accepts (INFO under the production
+// chain): walking the chain with a freshly built string, the manager's string
+// API, and the macro that skips formatting altogether
+void benchmarkFilteredCalls() {
+    cout << "\n=== Filtered-out call benchmark (INFO under production chain) ===" << endl;
+    LoggerManager* logger = LoggerManager::getInstance();
+    logger->useProductionChain();
+    auto chain = LoggerChainBuilder::createProductionLoggerChain();
+    const int iterations = 2000000;
+    
+    auto timeIt = [&](const char* label, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) body(i);
+        double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        cout << label << ": " << nanos / iterations << " ns/call" << endl;
+    };
+    timeIt("chain walk + string build", [&](int i) {
+        chain->logMessage(LogLevel::INFO, "request " + to_string(i) + " served");
+    });
+    timeIt("manager string API       ", [&](int i) {
+        logger->info("request " + to_string(i) + " served");
+    });
+    timeIt("LOG_INFO macro           ", [&](int i) {
+        LOG_INFO("request ", i, " served");
+    });
+    timeIt("LOG_DEBUG macro          ", [&](int i) {
+        LOG_DEBUG("request ", i, " served");
+    });
+}
+
+// Formatted messages per second: the original ctime + string concatenation
+// path against the cached per-thread formatter in both timestamp modes
+void benchmarkTimestampFormatting() {
+    cout << "\n=== Message formatting benchmark ===" << endl;
+    const int iterations = 1000000;
+    const string message = "order 42 processed in 17 ms by worker-7";
+    size_t checksum = 0;
+    
+    auto timeIt = [&](const char* label, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) body();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << label << ": " << (long)(iterations / seconds) << " msgs/sec" << endl;
+    };
+    timeIt("before (ctime + string temporaries)", [&]() {
+        time_t now = time(0);
+        string timeStr(ctime(&now));
+        timeStr.pop_back();
+        string formatted = "[" + timeStr + "] [" + logLevelToString(LogLevel::WARNING) + "] " + message;
+        checksum += formatted.size();
+    });
+    
+    struct FormatProbe : ConsoleLogger {
+        FormatProbe() : ConsoleLogger(LogLevel::INFO) {}
+        size_t formattedLength(const string& message) { return formatMessage(message, LogLevel::WARNING).view().size(); }
+    } probe;
+    timeIt("after, wall clock                  ", [&]() { checksum += probe.formattedLength(message); });
+    setTimestampMode(TimestampMode::MonotonicMicros);
+    timeIt("after, monotonic microseconds      ", [&]() { checksum += probe.formattedLength(message); });
+    setTimestampMode(TimestampMode::WallClock);
+    if (checksum == 0) cout << "(unreachable)" << endl;
+}
+
+// End-to-end throughput (until the file is written) of the same message via
+// the original synchronous text chain, the async text chain and binary mode
+void benchmarkBinaryLogging() {
+    cout << "\n=== Binary vs text logging throughput ===" << endl;
+    LoggerManager* logger = LoggerManager::getInstance();
+    
+    auto throughput = [](int messages, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        body(messages);
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        return messages / seconds;
+    };
+    
+    streambuf* console = cout.rdbuf(nullptr);  // FileLogger reports every write on cout
+    double syncText = throughput(20000, [&](int messages) {
+        logger->useProductionChain();
+        for (int i = 0; i < messages; i++) {
+            logger->warning("order " + to_string(i) + " took " + to_string(i % 97) + " ms");
+        }
+    });
+    cout.rdbuf(console);
+    remove("production.log");
+    
+    double asyncText = throughput(500000, [&](int messages) {
+        auto backend = make_shared<AsyncLogBackend>("bench_text.log");
+        logger->useAsyncProductionChain(backend);
+        for (int i = 0; i < messages; i++) {
+            logger->warning("order " + to_string(i) + " took " + to_string(i % 97) + " ms");
+        }
+        logger->useProductionChain();
+        backend->flush();
+    });
+    remove("bench_text.log");
+    
+    double binary = throughput(500000, [&](int messages) {
+        BinaryLogBackend backend("bench_binary.binlog");
+        for (int i = 0; i < messages; i++) {
+            BLOG(backend, LogLevel::WARNING, "order {} took {} ms", i, i % 97);
+        }
+        backend.flush();
+    });
+    remove("bench_binary.binlog");
+    
+    cout << "sync text chain : " << (long)syncText << " msgs/sec" << endl;
+    cout << "async text chain: " << (long)asyncText << " msgs/sec" << endl;
+    cout << "binary mode     : " << (long)binary << " msgs/sec (" << binary / asyncText << "x async text, "
+         << binary / syncText << "x sync text)" << endl;
+}
+
+// Lines/sec through a RotatingFileSink under each flush policy (1% of the
+// lines are ERRORs), against the original open-append-close per line; then a
+// small size cap to exercise rotation, compression and pruning
+void benchmarkRotatingSink() {
+    cout << "\n=== Rotating file sink benchmark ===" << endl;
+    const string line = "FILE: [Mon Oct 19 14:53:18 2026] [WARNING] order 42 processed in 17 ms by worker-7";
+    
+    auto throughput = [](int lines, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        body(lines);
+        return lines / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    };
+    
+    double reopen = throughput(20000, [&](int lines) {
+        for (int i = 0; i < lines; i++) {
+            ofstream file("bench_sink.log", ios::app);
+            file << line << endl;
+        }
+    });
+    remove("bench_sink.log");
+    cout << "reopen per line (original FileLogger): " << (long)reopen << " lines/sec" << endl;
+    
+    const FlushPolicy policies[] = {FlushPolicy::EveryMessage, FlushPolicy::Periodic, FlushPolicy::OnError};
+    const char* names[] = {"every message", "periodic 100ms", "on ERROR/FATAL"};
+    for (int p = 0; p < 3; p++) {
+        RotationConfig config;
+        config.flushPolicy = policies[p];
+        config.flushInterval = chrono::milliseconds(100);
+        config.maxFileBytes = 1ull << 40;
+        double rate = throughput(p == 0 ? 200000 : 1000000, [&](int lines) {
+            RotatingFileSink sink("bench_sink.log", config);
+            for (int i = 0; i < lines; i++) {
+                sink.append(i % 100 == 0 ? LogLevel::ERROR : LogLevel::WARNING, line);
+            }
+        });
+        remove("bench_sink.log");
+        cout << names[p] << ": " << (long)rate << " lines/sec" << endl;
+    }
+    
+    RotationConfig config;
+    config.maxFileBytes = 256 * 1024;
+    config.maxRotatedSegments = 3;
+    config.flushPolicy = FlushPolicy::Periodic;
+    vector<string> segments;
+    {
+        RotatingFileSink sink("bench_rotate.log", config);
+        for (int i = 0; i < 20000; i++) {
+            sink.append(LogLevel::WARNING, line);
+        }
+        sink.waitForMaintenance();
+        segments = sink.getRetainedSegments();
+    }
+    size_t compressed = 0;
+    for (const string& segment : segments) {
+        if (segment.size() > 3 && segment.compare(segment.size() - 3, 3, ".gz") == 0) compressed++;
+        remove(segment.c_str());
+    }
+    remove("bench_rotate.log");
+    cout << "rotation at 256 KiB: " << segments.size() << " segments retained (cap 3), " << compressed
+         << " gzip-compressed" << endl;
+}
+
+// Messages/sec from 1 to 64 producer threads logging through the manager:
+// merged per-thread buffers against every thread writing to one shared,
+// lock-protected stream. The merged file is checked for completeness and
+// per-thread order.
+void benchmarkMergedLogging() {
+    cout << "\n=== Per-thread buffers vs shared stream (400k messages) ===" << endl;
+    LoggerManager* logger = LoggerManager::getInstance();
+    const int totalMessages = 400000;
+    
+    for (int producers = 1; producers <= 64; producers *= 2) {
+        int perThread = totalMessages / producers;
+        auto runThreads = [&](auto&& logOne) {
+            vector<thread> threads;
+            for (int t = 0; t < producers; t++) {
+                threads.emplace_back([&, t]() {
+                    string prefix = "t" + to_string(t) + " #";
+                    for (int i = 0; i < perThread; i++) {
+                        logOne(prefix + to_string(i));
+                    }
+                });
+            }
+            for (auto& t : threads) t.join();
+        };
+        
+        auto start = chrono::steady_clock::now();
+        {
+            mutex streamMutex;
+            ofstream out("bench_shared.log");
+            runThreads([&](const string& message) {
+                lock_guard<mutex> lock(streamMutex);
+                out << "FILE: [" << getCurrentTimestamp() << "] [WARNING] " << message << '\n';
+            });
+        }
+        double shared = producers * perThread / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        remove("bench_shared.log");
+        
+        start = chrono::steady_clock::now();
+        {
+            auto collector = make_shared<MergingLogCollector>("bench_merged.log");
+            logger->useMergedProductionChain(collector);
+            runThreads([&](const string& message) { logger->warning(message); });
+            logger->useProductionChain();
+            collector->flush();
+        }
+        double merged = producers * perThread / chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        
+        vector<int> nextExpected(producers, 0);
+        long lines = 0;
+        bool ordered = true;
+        ifstream in("bench_merged.log");
+        string line;
+        while (getline(in, line)) {
+            size_t at = line.rfind("] t");
+            size_t hash = line.find(" #", at);
+            int thread = stoi(line.substr(at + 3, hash - at - 3));
+            int index = stoi(line.substr(hash + 2));
+            ordered = ordered && index == nextExpected[thread];
+            nextExpected[thread] = index + 1;
+            lines++;
+        }
+        in.close();
+        remove("bench_merged.log");
+        
+        cout << producers << " producers: shared stream " << (long)shared << " msgs/sec, merged buffers "
+             << (long)merged << " msgs/sec, " << lines << " lines, per-thread order "
+             << (ordered && lines == producers * perThread ? "OK" : "BROKEN") << endl;
+    }
+    
+    // Messages longer than a buffer slot arrive whole, under their own level
+    const string longMessage(5000, 'x');
+    {
+        auto collector = make_shared<MergingLogCollector>("bench_merged.log");
+        MergedLogger handler(LogLevel::WARNING, collector);
+        handler.handle(LogLevel::ERROR, longMessage);
+        collector->flush();
+    }
+    ifstream in("bench_merged.log");
+    string line;
+    getline(in, line);
+    in.close();
+    remove("bench_merged.log");
+    bool whole = line.size() > longMessage.size() &&
+                 line.compare(line.size() - longMessage.size(), string::npos, longMessage) == 0;
+    cout << "5000-byte ERROR: " << (whole ? "written whole" : "TRUNCATED") << ", level "
+         << (line.find("[ERROR]") != string::npos ? "ERROR" : "WRONG") << endl;
+}
+
+// Per-message cost of the ErrorLogger alert decision: a storm of one error,
+// a storm of one template with changing numbers, and 500 distinct templates
+// round-robin; plus what a 1M-error storm turns into on the alert path
+void benchmarkAlertThrottle() {
+    cout << "\n=== Alert throttle benchmark ===" << endl;
+    const int iterations = 1000000;
+    
+    vector<string> sameMessage(1, "payment gateway timeout after 30000 ms");
+    vector<string> sameTemplate, manyTemplates;
+    for (int i = 0; i < 1000; i++) {
+        sameTemplate.push_back("payment gateway timeout after " + to_string(30000 + i) + " ms");
+    }
+    for (int i = 0; i < 500; i++) {
+        manyTemplates.push_back("subsystem-" + string(1, (char)('a' + i % 26)) + string(1, (char)('a' + i / 26)) +
+                                " failed: connection refused");
+    }
+    
+    auto run = [&](const char* label, const vector<string>& messages) {
+        AlertThrottle throttle;
+        int admitted = 0;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            admitted += throttle.admit(messages[i % messages.size()]);
+        }
+        double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+        size_t summaries = throttle.collectSummaries().size();
+        cout << label << ": " << nanos << " ns/message, " << admitted << " alerts, "
+             << iterations - admitted << " suppressed in " << summaries << " summary records" << endl;
+    };
+    run("one message     ", sameMessage);
+    run("one template    ", sameTemplate);
+    run("500 templates   ", manyTemplates);
+}
+
+// Level-check cost of module-aware calls against the global check, then
+// throughput with DEBUG switched on for one module in production, in full
+// and sampled, while another module's DEBUG calls stay filtered
+void benchmarkModuleLevels() {
+    cout << "\n=== Module levels and sampling benchmark ===" << endl;
+    LoggerManager* logger = LoggerManager::getInstance();
+    logger->useProductionChain();
+    LogModule payments = logger->getModule("payments");
+    LogModule search = logger->getModule("search");
+    const int iterations = 2000000;
+    
+    auto timeIt = [&](const char* label, auto&& body) {
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) body(i);
+        double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+        cout << label << ": " << nanos / iterations << " ns/call" << endl;
+    };
+    timeIt("global check, filtered        ", [&](int i) {
+        LOG_AT(LogLevel::INFO, "request ", i, " served");
+    });
+    timeIt("module inherits chain, filtered", [&](int i) {
+        LOG_MODULE(search, LogLevel::INFO, "request ", i, " served");
+    });
+    logger->setModuleLevel(search, LogLevel::ERROR);
+    timeIt("module level ERROR, WARNING   ", [&](int i) {
+        LOG_MODULE(search, LogLevel::WARNING, "request ", i, " served");
+    });
+    logger->resetModuleLevel(search);
+    int kept = 0;
+    logger->setModuleLevel(payments, LogLevel::INFO);
+    logger->setModuleSampling(payments, LogLevel::INFO, 0.0);
+    timeIt("module sampled at 0%, draw only", [&](int) {
+        kept += logger->isEnabled(payments, LogLevel::INFO);
+    });
+    
+    auto backend = make_shared<AsyncLogBackend>("bench_modules.log", 1 << 16);
+    logger->useAsyncProductionChain(backend);
+    logger->setModuleLevel(payments, LogLevel::DEBUG);
+    const int messages = 500000;
+    auto countLines = []() {
+        ifstream in("bench_modules.log");
+        long lines = 0;
+        string line;
+        while (getline(in, line)) lines++;
+        return lines;
+    };
+    for (double keep : {1.0, 0.01}) {
+        logger->setModuleSampling(payments, LogLevel::DEBUG, keep);
+        long before = countLines();
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < messages; i++) {
+            LOG_MODULE(payments, LogLevel::DEBUG, "charge ", i, " authorised");
+            LOG_MODULE(search, LogLevel::DEBUG, "query ", i, " parsed");
+        }
+        backend->flush();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << "payments DEBUG kept " << keep * 100 << "%: " << (long)(2 * messages / seconds)
+             << " calls/sec, " << countLines() - before << " lines written" << endl;
+    }
+    logger->resetModuleLevel(payments);
+    logger->setModuleSampling(payments, LogLevel::DEBUG, 1.0);
+    logger->setModuleSampling(payments, LogLevel::INFO, 1.0);
+    logger->useDefaultChain();
+    backend.reset();
+    remove("bench_modules.log");
+    if (kept != 0) cout << "unexpected: " << kept << " messages passed a 0% sample" << endl;
+}
+
+// Body of the crash test process started by benchmarkCrashSafeSink
+[[noreturn]] void runCrashChild(int chainMessages, int asyncMessages) {
+    auto ring = make_shared<MappedRingSink>("bench_crash.maplog");
+    auto backend = make_shared<AsyncLogBackend>("bench_crash_async.log", 1 << 16);
+    backend->mirrorOnCrash(ring);
+    CrashFlusher::installSignalHandlers();
+    
+    LoggerManager* logger = LoggerManager::getInstance();
+    logger->useCrashSafeProductionChain(ring);
+    for (int i = 0; i < chainMessages; i++) {
+        logger->warning("chain #" + to_string(i));
+    }
+    string text;
+    for (int i = 0; i < asyncMessages; i++) {
+        text = "async #" + to_string(i);
+        backend->push(LogLevel::WARNING, text);
+    }
+    raise(SIGSEGV);
+    _exit(0);  // not reached
+}
+
+// Child process for the orderly FATAL path: a plain async backend and a
+// periodically flushed file sink hold messages in memory when it aborts
+[[noreturn]] void runFatalChild(int messages) {
+    auto backend = make_shared<AsyncLogBackend>("bench_fatal_async.log", 1 << 16);
+    RotationConfig config;
+    config.flushPolicy = FlushPolicy::Periodic;
+    config.flushInterval = chrono::hours(1);
+    config.bufferBytes = 64 << 20;
+    auto sink = make_shared<RotatingFileSink>("bench_fatal_periodic.log", config);
+    
+    LoggerManager* logger = LoggerManager::getInstance();
+    logger->useAsyncProductionChain(backend);
+    string text;
+    for (int i = 0; i < messages; i++) {
+        text = "buffered #" + to_string(i);
+        backend->push(LogLevel::WARNING, text);
+        sink->append(LogLevel::WARNING, text);
+    }
+    logger->fatalAndAbort("giving up");
+}
+
+// Path of the running binary, for re-spawning it as a crash test child
+static string executablePath() {
+#ifdef __APPLE__
+    uint32_t size = 0;
+    _NSGetExecutablePath(nullptr, &size);
+    string path(size, '\0');
+    if (_NSGetExecutablePath(&path[0], &size) != 0) return "";
+    path.resize(strlen(path.c_str()));
+    return path;
+#else
+    char path[PATH_MAX];
+    ssize_t length = readlink("/proc/self/exe", path, sizeof(path));
+    return length > 0 ? string(path, length) : "";
+#endif
+}
+
+static long countLines(const string& path) {
+    ifstream in(path);
+    string line;
+    long lines = 0;
+    while (getline(in, line)) lines++;
+    return lines;
+}
+
+// Cost of one MappedRingSink append, then a real crash: a child process logs
+// through the crash-safe chain and an async backend mirrored into the ring,
+// dies on SIGSEGV, and the parent recovers what survived from the file
+void benchmarkCrashSafeSink() {
+    cout << "\n=== Crash-safe mapped sink benchmark ===" << endl;
+    const string message = "order 42 processed in 17 ms by worker-7";
+    {
+        MappedRingSink sink("bench_crash.maplog", 1 << 20);
+        const int iterations = 1000000;
+        auto start = chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            sink.append(LogLevel::WARNING, message, 0);
+        }
+        double nanos = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / iterations;
+        cout << "append: " << nanos << " ns/record" << endl;
+    }
+    
+    // A fresh process rather than fork(): this one has sink threads a forked child would not inherit
+    const int chainMessages = 20000, asyncMessages = 20000;
+    string self = executablePath();
+    char* childArgs[] = {(char*)self.c_str(), (char*)"--crash-child", nullptr};
+    pid_t child;
+    if (self.empty() || posix_spawn(&child, self.c_str(), nullptr, nullptr, childArgs, environ) != 0) {
+        cerr << "Error: Could not start the crash test process" << endl;
+        return;
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    bool crashed = WIFSIGNALED(status) && WTERMSIG(status) == SIGSEGV;
+    
+    ifstream in("bench_crash.maplog", ios::binary);
+    string file((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+    MappedLogHeader header;
+    memcpy(&header, file.data(), sizeof(header));
+    long chainRecovered = 0, asyncSalvaged = 0;
+    bool lastChainMessage = false;
+    // Every async message must turn up exactly once, in the file or in the ring
+    vector<int> asyncSeen(asyncMessages, 0);
+    auto seeAsync = [&](string_view text) {
+        size_t at = text.find("async #");
+        if (at == string_view::npos) return false;
+        int number = atoi(string(text.substr(at + 7)).c_str());
+        if (number >= 0 && number < asyncMessages) asyncSeen[number]++;
+        return true;
+    };
+    forEachMappedRecord(file.data() + MappedLogDataOffset, header.capacity, header.writePosition,
+                        [&](const MappedRecordHeader& record, const char* payload) {
+        string_view text(payload, record.length);
+        if (text.find("async #") == 0) {
+            seeAsync(text);
+            asyncSalvaged++;
+        } else if (text.find("chain #") != string_view::npos) {
+            chainRecovered++;
+            lastChainMessage = lastChainMessage ||
+                text.find("chain #" + to_string(chainMessages - 1)) != string_view::npos;
+        }
+    });
+    
+    long asyncWritten = 0;
+    ifstream asyncLog("bench_crash_async.log");
+    string line;
+    while (getline(asyncLog, line)) {
+        if (seeAsync(line)) asyncWritten++;
+    }
+    asyncLog.close();
+    remove("bench_crash.maplog");
+    remove("bench_crash_async.log");
+    
+    cout << "child " << (crashed ? "died on SIGSEGV" : "did NOT crash as expected") << "; chain records recovered: "
+         << chainRecovered << "/" << chainMessages << ", last message " << (lastChainMessage ? "present" : "MISSING")
+         << endl;
+    long asyncOnce = count(asyncSeen.begin(), asyncSeen.end(), 1);
+    long asyncTwice = count_if(asyncSeen.begin(), asyncSeen.end(), [](int seen) { return seen > 1; });
+    cout << "async backend: " << asyncWritten << " written by the consumer + " << asyncSalvaged
+         << " salvaged from the ring at crash" << endl;
+    cout << (asyncOnce == asyncMessages ? "PASS" : "FAIL") << " every async message kept exactly once ("
+         << asyncOnce << "/" << asyncMessages << ", " << asyncTwice << " duplicated)" << endl;
+    
+    // fatalAndAbort drains every buffering sink, mirrored or not
+    const int fatalMessages = 20000;
+    char* fatalArgs[] = {(char*)self.c_str(), (char*)"--fatal-child", nullptr};
+    posix_spawn_file_actions_t quiet;
+    posix_spawn_file_actions_init(&quiet);
+    posix_spawn_file_actions_addopen(&quiet, STDOUT_FILENO, "/dev/null", O_WRONLY, 0);
+    posix_spawn_file_actions_addopen(&quiet, STDERR_FILENO, "/dev/null", O_WRONLY, 0);
+    bool spawned = posix_spawn(&child, self.c_str(), &quiet, nullptr, fatalArgs, environ) == 0;
+    posix_spawn_file_actions_destroy(&quiet);
+    if (!spawned) {
+        cerr << "Error: Could not start the fatal test process" << endl;
+        return;
+    }
+    waitpid(child, &status, 0);
+    bool aborted = WIFSIGNALED(status) && WTERMSIG(status) == SIGABRT;
+    long asyncLines = countLines("bench_fatal_async.log");      // includes the FATAL line
+    long periodicLines = countLines("bench_fatal_periodic.log");
+    remove("bench_fatal_async.log");
+    remove("bench_fatal_periodic.log");
+    cout << "fatalAndAbort " << (aborted ? "aborted" : "did NOT abort") << "; plain async backend "
+         << min(asyncLines, (long)fatalMessages) << "/" << fatalMessages << ", periodic file sink "
+         << periodicLines << "/" << fatalMessages << " written" << endl;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && string(argv[1]) == "--crash-child") {
+        runCrashChild(20000, 20000);
+    }
+    if (argc > 1 && string(argv[1]) == "--fatal-child") {
+        runFatalChild(20000);
+    }
+    
     cout << "======================================" << endl;
     cout << "    LOGGER SYSTEM DEMONSTRATION       " << endl;
     cout << "  Chain of Responsibility Pattern     " << endl;
@@ -290,5 +3017,18 @@ int main() {
     cout << "✓ Flexible Configuration: Different chains for different environments" << endl;
     cout << "✓ Runtime Chain Modification: Can switch chains dynamically" << endl;
     
+    if (argc > 1 && string(argv[1]) == "--bench") {
+        benchmarkAsyncBackend();
+        stressChainSwap();
+        benchmarkFilteredCalls();
+        benchmarkTimestampFormatting();
+        benchmarkBinaryLogging();
+        benchmarkRotatingSink();
+        benchmarkMergedLogging();
+        benchmarkAlertThrottle();
+        benchmarkCrashSafeSink();
+        benchmarkModuleLevels();
+    }
+    
     return 0;
 }
\ No newline at end of file
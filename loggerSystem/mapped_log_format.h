@@ -0,0 +1,106 @@
+// Layout of the memory-mapped crash log written by MappedRingSink (main.cpp)
+// and read back by log_recover.cpp. All integers are stored in host byte order.
+//
+// The file is a 64-byte header followed by a ring of `capacity` bytes. Each
+// record starts on a 32-byte boundary at ring offset (position % capacity)
+// and its payload may wrap around the end of the ring. A record whose
+// checksum does not match (torn by a crash, or partly overwritten by a later
+// record) is skipped, and counted, by the reader.
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+const char MappedLogMagic[8] = {'M', 'A', 'P', 'L', 'O', 'G', '0', '1'};
+const size_t MappedLogDataOffset = 64;
+const size_t MappedRecordAlignment = 32;
+
+struct MappedLogHeader {
+    char magic[8];
+    uint64_t capacity;       // ring bytes, a multiple of MappedRecordAlignment
+    uint64_t writePosition;  // total bytes ever reserved; only grows
+};
+
+struct MappedRecordHeader {
+    uint32_t length;          // payload bytes; stored last when a record is written
+    uint32_t checksum;        // see mappedRecordChecksum
+    uint64_t position;        // ring position the record was reserved at (orders records)
+    int64_t timestampMicros;  // wall clock
+    uint8_t level;            // numeric LogLevel
+    uint8_t reserved[7];
+};
+
+static_assert(sizeof(MappedRecordHeader) == MappedRecordAlignment, "record header fills one alignment unit");
+
+// Bytes a record with `length` payload bytes occupies in the ring
+inline uint64_t mappedRecordSpan(uint64_t length) {
+    return (sizeof(MappedRecordHeader) + length + MappedRecordAlignment - 1) & ~(uint64_t)(MappedRecordAlignment - 1);
+}
+
+// Copies `count` ring bytes starting at ring offset `offset`, wrapping at the end
+inline void copyFromRing(const char* ring, uint64_t capacity, uint64_t offset, char* out, size_t count) {
+    size_t first = (size_t)(capacity - offset) < count ? (size_t)(capacity - offset) : count;
+    memcpy(out, ring + offset, first);
+    memcpy(out + first, ring, count - first);
+}
+
+// Checksum over the header fields and the (contiguous) payload, eight bytes at a time
+inline uint32_t mappedRecordChecksum(const MappedRecordHeader& header, const char* payload) {
+    uint64_t hash = 0x243F6A8885A308D3ull;
+    auto absorb = [&hash](uint64_t word) {
+        hash = (hash ^ word) * 0x9E3779B97F4A7C15ull;
+        hash ^= hash >> 31;
+    };
+    absorb(header.length | ((uint64_t)header.level << 32));
+    absorb(header.position);
+    absorb((uint64_t)header.timestampMicros);
+    size_t i = 0;
+    for (; i + 8 <= header.length; i += 8) {
+        uint64_t word;
+        memcpy(&word, payload + i, 8);
+        absorb(word);
+    }
+    if (i < header.length) {
+        uint64_t word = 0;
+        memcpy(&word, payload + i, header.length - i);
+        absorb(word);
+    }
+    return (uint32_t)(hash ^ (hash >> 32));
+}
+
+// Calls visit(const MappedRecordHeader&, const char* payload) for every intact
+// record still in the ring, oldest first. `payload` points to scratch memory
+// valid only during the call. Returns how many damaged stretches were skipped
+// (a torn record, or what is left of one the ring has partly overwritten).
+template <typename Visit>
+size_t forEachMappedRecord(const char* ring, uint64_t capacity, uint64_t writePosition, Visit&& visit) {
+    static thread_local char payload[1 << 16];
+    size_t skipped = 0;
+    bool skipping = false;
+    uint64_t position = writePosition > capacity ? writePosition - capacity : 0;
+    position = (position + MappedRecordAlignment - 1) & ~(uint64_t)(MappedRecordAlignment - 1);
+    while (position + sizeof(MappedRecordHeader) <= writePosition) {
+        MappedRecordHeader header;
+        memcpy(&header, ring + position % capacity, sizeof(header));
+        uint64_t span = mappedRecordSpan(header.length);
+        if (header.length == 0 || header.position != position || header.length > sizeof(payload) ||
+            position + span > writePosition) {
+            skipped += skipping ? 0 : 1;
+            skipping = true;
+            position += MappedRecordAlignment;  // torn or overwritten: resynchronise
+            continue;
+        }
+        copyFromRing(ring, capacity, (position + sizeof(MappedRecordHeader)) % capacity, payload, header.length);
+        if (mappedRecordChecksum(header, payload) != header.checksum) {
+            skipped += skipping ? 0 : 1;
+            skipping = true;
+            position += MappedRecordAlignment;
+            continue;
+        }
+        skipping = false;
+        visit(header, (const char*)payload);
+        position += span;
+    }
+    return skipped;
+}